@@ -0,0 +1,106 @@
+/*
+ *                             The MIT License
+ *
+ * Copyright (c) 2024 by Albert Jimenez-Blanco
+ *
+ * This file is part of #################### Theseus Library ####################.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+
+#pragma once
+
+#include <memory>
+
+#include "theseus/graph.h"
+#include "theseus/penalties.h"
+
+
+/**
+ * @file aligner_index.h
+ * @brief Header file for the AlignerIndex class. The index holds the data that
+ * does not change while aligning (the graph and the penalties), so that it can
+ * be shared by the workspaces of several threads.
+ *
+ */
+
+namespace theseus
+{
+    class AlignerWorkspace; // Forward declaration of the workspace class.
+    struct PenaltyModels;   // Forward declaration of the internal penalties.
+
+    /**
+     * Immutable part of a sequence-to-graph aligner: the reference graph and
+     * the penalties. An index is meant to be created once and shared through a
+     * std::shared_ptr<const AlignerIndex> by the AlignerWorkspace objects of
+     * all the threads that align against it.
+     *
+     * Thread safety: once constructed, an index is never modified, so any
+     * number of threads may use it (and the workspaces created from it) at the
+     * same time.
+     */
+    class AlignerIndex
+    {
+    public:
+        /**
+         * Constructor from graph. The graph is copied.
+         *
+         * @param penalties User defined alignment penalties
+         * @param graph Reference graph in the internal graph format
+         * @throws std::invalid_argument if the penalties are not supported
+         */
+        AlignerIndex(const Penalties &penalties,
+                     const Graph &graph);
+
+        /**
+         * Constructor from rvalued graph.
+         *
+         * @param penalties User defined alignment penalties
+         * @param graph Rvalued graph in the internal graph format
+         * @throws std::invalid_argument if the penalties are not supported
+         */
+        AlignerIndex(const Penalties &penalties,
+                     Graph &&graph);
+
+        /**
+         * Class destructor
+         *
+         */
+        ~AlignerIndex();
+
+        /**
+         * @return Reference graph
+         */
+        const Graph &graph() const { return *graph_; }
+
+        /**
+         * @return Alignment penalties
+         */
+        const Penalties &penalties() const;
+
+    private:
+        friend class AlignerWorkspace;
+
+        std::shared_ptr<const Graph> graph_;
+        std::shared_ptr<const PenaltyModels> penalties_;  // Validated once, read by the workspaces
+    };
+
+} // namespace theseus
@@ -0,0 +1,217 @@
+/*
+ *                             The MIT License
+ *
+ * Copyright (c) 2024 by Albert Jimenez-Blanco
+ *
+ * This file is part of #################### Theseus Library ####################.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+
+#pragma once
+
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "theseus/aligner_index.h"
+#include "theseus/alignment.h"
+#include "theseus/heuristics.h"
+
+
+/**
+ * @file aligner_workspace.h
+ * @brief Header file for the AlignerWorkspace class. A workspace holds the
+ * buffers of the alignments of one thread against a shared AlignerIndex.
+ *
+ */
+
+namespace theseus
+{
+    class TheseusAlignerImpl; // Forward declaration of the implementation class.
+    class TheseusAligner;     // Forward declaration of the aligner class.
+
+    /**
+     * Per-thread part of a sequence-to-graph aligner: the wavefronts, the
+     * scratchpad, the data of the active vertices and the heuristics. The
+     * graph and the penalties are read from the shared index, so a workspace
+     * only costs the memory of its buffers, which grow with the alignments
+     * and are reused by the following ones.
+     *
+     * Thread safety: a workspace must not be used by several threads at the
+     * same time, but any number of workspaces created from the same index can
+     * align concurrently. The alignments are the same as those of a
+     * TheseusAligner with the same penalties, heuristics and graph.
+     *
+     * Example:
+     *
+     *     auto index = std::make_shared<const theseus::AlignerIndex>(penalties, std::move(graph));
+     *     // On each thread
+     *     theseus::AlignerWorkspace workspace(index, heuristics);
+     *     theseus::Alignment alignment = workspace.align(seq, start_node, start_offset);
+     */
+    class AlignerWorkspace
+    {
+    public:
+        /**
+         * Constructor from a shared index.
+         *
+         * @param index Index with the graph and the penalties
+         * @param heuristics Heuristics object
+         */
+        AlignerWorkspace(std::shared_ptr<const AlignerIndex> index,
+                         const Heuristics &heuristics = Heuristics());
+
+        AlignerWorkspace(AlignerWorkspace &&) noexcept;
+        AlignerWorkspace &operator=(AlignerWorkspace &&) noexcept;
+
+        /**
+         * Class destructor
+         *
+         */
+        ~AlignerWorkspace();
+
+        /**
+         * @return Index the workspace aligns against
+         */
+        const std::shared_ptr<const AlignerIndex> &index() const { return index_; }
+
+        /**
+         * Aligns the given sequence to the graph of the index starting from
+         * the specified node and offset (see TheseusAligner::align).
+         *
+         * @param seq Sequence to be aligned
+         * @param start_node Starting node in the graph
+         * @param start_offset Starting offset within the starting node
+         * @param ends_free Ends-free options
+         * @return Alignment
+         */
+        Alignment align(std::string_view seq,
+                        NodeId start_node,
+                        int start_offset = 0,
+                        bool density_drop_active = false,
+                        bool lag_pruning_active = false,
+                        EndsFree ends_free = {});
+
+        /**
+         * Same as align, but the result is written into the given alignment,
+         * reusing its buffers (see TheseusAligner::align_into).
+         *
+         * @param alignment Output alignment (its previous contents are discarded)
+         * @param seq Sequence to be aligned
+         * @param start_node Starting node in the graph
+         * @param start_offset Starting offset within the starting node
+         * @param ends_free Ends-free options
+         */
+        void align_into(Alignment &alignment,
+                        std::string_view seq,
+                        NodeId start_node,
+                        int start_offset = 0,
+                        bool density_drop_active = false,
+                        bool lag_pruning_active = false,
+                        EndsFree ends_free = {});
+
+        /**
+         * Align a batch of small problems (e.g. short reads or polishing
+         * windows) on the calling thread. The sequences are aligned in the
+         * order of their start positions, so consecutive alignments walk the
+         * same region of the graph, and the sequences that are equal and
+         * start at the same position are aligned only once. The alignments
+         * are the same as those of align_into.
+         *
+         * @param alignments Output alignments, one per sequence (their previous contents are discarded)
+         * @param seqs Sequences to be aligned
+         * @param start_nodes Starting node of each sequence
+         * @param start_offsets Starting offset of each sequence
+         * @param ends_free Ends-free options
+         * @throws std::invalid_argument if the spans do not have the same size
+         */
+        void align_batch_into(std::span<Alignment> alignments,
+                              std::span<const std::string_view> seqs,
+                              std::span<const NodeId> start_nodes,
+                              std::span<const int> start_offsets,
+                              bool density_drop_active = false,
+                              bool lag_pruning_active = false,
+                              EndsFree ends_free = {});
+
+        /**
+         * Compute only the score and the end position of the alignment (see
+         * TheseusAligner::align_score).
+         *
+         * @param seq Sequence to be aligned
+         * @param start_node Starting node in the graph
+         * @param start_offset Starting offset within the starting node
+         * @param ends_free Ends-free options
+         * @return AlignmentScore
+         */
+        AlignmentScore align_score(std::string_view seq,
+                                   NodeId start_node,
+                                   int start_offset = 0,
+                                   bool density_drop_active = false,
+                                   bool lag_pruning_active = false,
+                                   EndsFree ends_free = {});
+
+        /**
+         * Linear-memory alignment (see TheseusAligner::align_bidirectional).
+         *
+         * @param seq Sequence to be aligned
+         * @param start_node Starting node in the graph
+         * @param start_offset Starting offset within the starting node
+         * @return Alignment
+         */
+        Alignment align_bidirectional(std::string_view seq,
+                                      NodeId start_node,
+                                      int start_offset = 0);
+
+        /**
+         * Replace the heuristics used by the following alignments of this
+         * workspace.
+         *
+         * @param heuristics Heuristics object
+         */
+        void set_heuristics(const Heuristics &heuristics);
+
+        /**
+         * Set the number of scores between checkpoints of align and
+         * align_into (see TheseusAligner::set_checkpoint_interval).
+         *
+         * @param interval Number of scores between checkpoints (0 disables them)
+         */
+        void set_checkpoint_interval(int interval);
+
+        /**
+         * Compute each alignment of this workspace on several threads (see
+         * TheseusAligner::set_parallel_wave).
+         *
+         * @param num_threads Number of threads (0 or 1 computes each alignment on the calling thread)
+         */
+        void set_parallel_wave(int num_threads);
+
+    private:
+        friend class TheseusAligner;
+
+        std::shared_ptr<const AlignerIndex> index_;
+        std::unique_ptr<TheseusAlignerImpl> aligner_impl_;
+        std::vector<size_t> batch_order_;   // Order of the sequences of align_batch_into
+    };
+
+} // namespace theseus
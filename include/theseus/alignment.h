@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <string>
 #include <vector>
 #include "theseus/graph.h"
 #include "theseus/penalties.h"
@@ -42,6 +43,17 @@ namespace theseus {
 
 using NodeId = Graph::NodeId;
 
+/**
+ * Run of equal edit operations of a CIGAR.
+ *
+ */
+struct CigarRun {
+    char op;        // Edit operation ('M', 'X', 'I' or 'D')
+    int  length;    // Number of consecutive operations
+
+    bool operator==(const CigarRun &other) const = default;
+};
+
 class Alignment {
     public:
     /*
@@ -83,13 +95,15 @@ class Alignment {
 
       /**
        * @brief Backtrace objects: similar to the CIGAR in sequence alignment. It consists
-       *        of the set of edit operations of the alignment and the path of the alignment
+       *        of the runs of edit operations of the alignment and the path of the alignment
        *        through the reference graph.
        */
-      std::vector<char> edit_op;    // Edit operations
+      std::vector<CigarRun> cigar;  // Run-length edit operations
       std::vector<NodeId> path;     // Path of the alignment
       int start_offset;             // Start offset in the first vertex of the path
       int end_offset;               // End offset in the last vertex of the path
+      int query_length;             // Length of the aligned query
+      int query_end;                // End of the alignment in the query (the rest is unaligned)
       int theseus_status;           // Alignment status
 
 
@@ -103,43 +117,102 @@ class Alignment {
        */
       int compute_affine_gap_score(Penalties &user_penalties) {
           int score = 0;
-          bool insertion_open = false, deletion_open = false;
-          for (const auto &op : edit_op) {
-              if (op == 'X') {
-                  insertion_open = false;
-                  deletion_open = false;
-                  score += user_penalties.mism(); // Mismatch score
+          char prev_op = 0;
+          for (const auto &run : cigar) {
+              if (run.op == 'X') {
+                  score += run.length * user_penalties.mism(); // Mismatch score
               }
-              else if (op == 'I') {
-                  deletion_open = false;
-                  if (!insertion_open) {
-                      insertion_open = true;
-                      score += user_penalties.gapo() + user_penalties.gape(); // Gap open penalty for insertion
-                  }
-                  else {
-                      score += user_penalties.gape(); // Gap extend penalty for insertion
-                  }
-              }
-              else if (op == 'D') {
-                  insertion_open = false;
-                  if (!deletion_open) {
-                      deletion_open = true;
-                      score += user_penalties.gapo() + user_penalties.gape(); // Gap open penalty for deletion
-                  }
-                  else {
-                      score += user_penalties.gape(); // Gap extend penalty for deletion
+              else if (run.op == 'I' || run.op == 'D') {
+                  // Gap open penalty, unless the gap continues the previous run
+                  if (run.op != prev_op) {
+                      score += user_penalties.gapo();
                   }
+                  score += run.length * user_penalties.gape(); // Gap extend penalty
               }
-              else if (op == 'M') {
-                  insertion_open = false;
-                  deletion_open = false;
-                  score += user_penalties.match(); // Match score
+              else if (run.op == 'M') {
+                  score += run.length * user_penalties.match(); // Match score
               }
+              prev_op = run.op;
           }
           return score;
       }
 
+      /**
+       * @brief Append "length" operations "op" to the CIGAR, extending its
+       * last run if it has the same operation.
+       *
+       * @param op
+       * @param length
+       */
+      void add_ops(char op, int length) {
+          if (length <= 0) return;
+          if (!cigar.empty() && cigar.back().op == op) {
+              cigar.back().length += length;
+          }
+          else {
+              cigar.push_back(CigarRun{op, length});
+          }
+      }
+
+      /**
+       * @brief Expand the CIGAR into one edit operation per position.
+       *
+       * @return std::vector<char> Edit operations
+       */
+      std::vector<char> edit_ops() const {
+          std::vector<char> ops;
+          for (const auto &run : cigar) {
+              ops.insert(ops.end(), run.length, run.op);
+          }
+          return ops;
+      }
+
+      /**
+       * @brief CIGAR string of the alignment (e.g. "10M1X3I").
+       *
+       */
+      std::string cigar_string() const {
+          std::string str;
+          for (const auto &run : cigar) {
+              str += std::to_string(run.length);
+              str += run.op;
+          }
+          return str;
+      }
+
     private:
 };
 
+/**
+ * Ends-free options of the sequence-to-graph alignment. By default, the
+ * alignment covers the whole query and may end at any position of the graph.
+ * The alignment stops at the first score where one of the allowed ends is
+ * reached.
+ */
+struct EndsFree {
+    // The alignment may also end at the end of a sink vertex of the graph
+    // before covering the whole query, leaving the rest of the query unaligned
+    bool query_suffix = false;
+    // The alignment may end at any position of the graph. Otherwise, it has to
+    // end at the end of a sink vertex
+    bool graph_suffix = true;
+};
+
+/**
+ * Result of a score-only alignment: the score and the end position of the
+ * alignment, without the CIGAR and the path.
+ *
+ * The score is computed with the internal penalties, which are the user
+ * penalties when the match score is 0. Otherwise, the penalties are
+ * transformed to have a null match score, and the score cannot be converted
+ * back without the alignment.
+ */
+struct AlignmentScore {
+    int score = -1;                          // Alignment score (internal penalties)
+    NodeId end_node = 0;                     // Last vertex of the alignment
+    int end_offset = -1;                     // End offset in the last vertex of the alignment
+    int query_end = -1;                      // End of the alignment in the query
+    int theseus_status = THESEUS_STATUS_OK;  // Alignment status
+};
+
 } // namespace theseus
\ No newline at end of file
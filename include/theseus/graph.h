@@ -6,6 +6,8 @@
 #include <string_view>
 #include <iostream>
 
+#include "theseus/packed_sequence.h"
+
 /**
  * The internal graph used by the Theseus aligner.
  *
@@ -216,69 +218,72 @@ public:
         iterator end_;
     };
 
+    /**
+     * A non-owning, possibly reversed, view of a sequence. The viewed
+     * characters are either plain characters (std::string_view) or a window
+     * [offset, offset + size) of a PackedSequence.
+     */
     class SequenceView {
     public:
         struct iterator {
             using iterator_category = std::random_access_iterator_tag;
             using value_type = char;
             using difference_type = std::ptrdiff_t;
-            using pointer = const char *;
-            using reference = const char &;
+            using reference = char;
 
-            const char *ptr;
-            int step;  // +1 forward, -1 reverse
-            int deref_offset;  // 0 for forward, -1 for reverse
+            std::string_view data;
+            const PackedSequence *packed;
+            size_t packed_offset;
+            size_t packed_size;
+            bool reversed;
+            difference_type idx;
 
             reference operator[](difference_type n) const {
-                return *(*this + n);
+                return SequenceView::at(data, packed, packed_offset, packed_size, reversed, idx + n);
             }
 
             reference operator*() const {
-                return *(ptr + deref_offset);
-            }
-
-            pointer operator->() const {
-                return ptr + deref_offset;
+                return SequenceView::at(data, packed, packed_offset, packed_size, reversed, idx);
             }
 
             iterator &operator++() {
-                ptr += step;
+                ++idx;
                 return *this;
             }
 
             iterator operator++(int) {
                 iterator tmp = *this;
-                ptr += step;
+                ++idx;
                 return tmp;
             }
 
             iterator &operator--() {
-                ptr -= step;
+                --idx;
                 return *this;
             }
 
             iterator operator--(int) {
                 iterator tmp = *this;
-                ptr -= step;
+                --idx;
                 return tmp;
             }
 
             iterator &operator+=(difference_type n) {
-                ptr += n * step;
+                idx += n;
                 return *this;
             }
 
             iterator &operator-=(difference_type n) {
-                ptr -= n * step;
+                idx -= n;
                 return *this;
             }
 
             iterator operator+(difference_type n) const {
-                return {ptr + n * step, step, deref_offset};
+                return {data, packed, packed_offset, packed_size, reversed, idx + n};
             }
 
             iterator operator-(difference_type n) const {
-                return {ptr - n * step, step, deref_offset};
+                return {data, packed, packed_offset, packed_size, reversed, idx - n};
             }
 
             friend iterator operator+(difference_type n, const iterator &it) {
@@ -286,48 +291,44 @@ public:
             }
 
             difference_type operator-(const iterator &other) const {
-                return (ptr - other.ptr) * step;
+                return idx - other.idx;
             }
 
             bool operator==(const iterator &o) const {
-                return ptr == o.ptr && step == o.step;
+                return idx == o.idx;
             }
 
             bool operator!=(const iterator &o) const { return !(*this == o); }
 
-            bool operator<(const iterator &o) const { return (ptr - o.ptr) * step < 0; }
-            bool operator>(const iterator &o) const { return (ptr - o.ptr) * step > 0; }
-            bool operator<=(const iterator &o) const { return (ptr - o.ptr) * step <= 0; }
-            bool operator>=(const iterator &o) const { return (ptr - o.ptr) * step >= 0; }
+            bool operator<(const iterator &o) const { return idx < o.idx; }
+            bool operator>(const iterator &o) const { return idx > o.idx; }
+            bool operator<=(const iterator &o) const { return idx <= o.idx; }
+            bool operator>=(const iterator &o) const { return idx >= o.idx; }
         };
 
         SequenceView(std::string_view sv, bool reversed = false)
-            : data_(sv), reversed_(reversed) {}
+            : data_(sv), packed_(nullptr), packed_offset_(0), packed_size_(0), reversed_(reversed) {}
+
+        SequenceView(const PackedSequence *packed, bool reversed = false)
+            : data_(), packed_(packed), packed_offset_(0), packed_size_(packed->size()), reversed_(reversed) {}
+
+        SequenceView(const PackedSequence *packed, size_t offset, size_t size, bool reversed = false)
+            : data_(), packed_(packed), packed_offset_(offset), packed_size_(size), reversed_(reversed) {}
 
         iterator begin() const {
-            if (!reversed_) {
-                return {data_.data(), 1, 0};
-            }
-            else {
-                return {data_.data() + data_.size(), -1, -1};
-            }
+            return {data_, packed_, packed_offset_, packed_size_, reversed_, 0};
         }
 
         iterator end() const {
-            if (!reversed_) {
-                return {data_.data() + data_.size(), 1, 0};
-            }
-            else {
-                return {data_.data(), -1, -1};
-            }
+            return {data_, packed_, packed_offset_, packed_size_, reversed_, static_cast<std::ptrdiff_t>(size())};
         }
 
-        size_t size() const { return data_.size(); }
+        size_t size() const { return (packed_ == nullptr) ? data_.size() : packed_size_; }
 
-        bool empty() const { return data_.empty(); }
+        bool empty() const { return size() == 0; }
 
         char operator[](size_t idx) const {
-            return reversed_ ? data_[data_.size() - 1 - idx] : data_[idx];
+            return at(data_, packed_, packed_offset_, packed_size_, reversed_, idx);
         }
 
         // Output
@@ -344,12 +345,58 @@ public:
 
         [[nodiscard]] bool is_reversed() const noexcept { return reversed_; }
 
+        /**
+         * Check if the viewed characters are stored in a PackedSequence.
+         *
+         * @return true if the view is backed by a PackedSequence, false otherwise.
+         */
+        [[nodiscard]] bool is_packed() const noexcept { return packed_ != nullptr; }
+
+        /**
+         * Get the underlying characters in their original (forward) order,
+         * regardless of the orientation of the view. Empty for packed views.
+         *
+         * @return The viewed characters in forward orientation.
+         */
+        [[nodiscard]] std::string_view underlying() const noexcept { return data_; }
+
+        /**
+         * Get the underlying packed sequence (in its original forward order),
+         * or nullptr if the view is not packed. The viewed bases are
+         * [packed_offset(), packed_offset() + size()) of this sequence.
+         *
+         * @return The packed sequence holding the viewed bases.
+         */
+        [[nodiscard]] const PackedSequence *packed() const noexcept { return packed_; }
+
+        /**
+         * Get the position of the first viewed base (in forward order) within
+         * packed(). Zero for views that are not packed.
+         *
+         * @return The offset of the view in its packed sequence.
+         */
+        [[nodiscard]] size_t packed_offset() const noexcept { return packed_offset_; }
+
         [[nodiscard]] SequenceView reversed() const noexcept {
-            return SequenceView(data_, !reversed_);
+            SequenceView view = *this;
+            view.reversed_ = !reversed_;
+            return view;
         }
 
     private:
+        static char at(std::string_view data, const PackedSequence *packed,
+                       size_t packed_offset, size_t packed_size,
+                       bool reversed, size_t idx) {
+            if (packed == nullptr) {
+                return reversed ? data[data.size() - 1 - idx] : data[idx];
+            }
+            return (*packed)[packed_offset + (reversed ? packed_size - 1 - idx : idx)];
+        }
+
         std::string_view data_;
+        const PackedSequence *packed_;
+        size_t packed_offset_;
+        size_t packed_size_;
         bool reversed_;
     };
 
@@ -627,6 +674,56 @@ public:
      */
     [[nodiscard]] int node_size(NodeId id) const;
 
+    /**
+     * @brief Return the length of the longest node sequence. The number of
+     * nodes of each length is maintained as the graph is modified, so this
+     * only reads the graph and is safe on a graph shared by several threads.
+     *
+     * @return The maximum node length (0 for an empty graph).
+     */
+    [[nodiscard]] int max_node_size() const;
+
+    /**
+     * @brief Return the total length of the node sequences.
+     *
+     * @return The sum of the lengths of all node sequences.
+     */
+    [[nodiscard]] size_t total_sequence_length() const;
+
+    /**
+     * Get the number of edges in the graph.
+     *
+     * @return The total number of edges in the graph.
+     */
+    [[nodiscard]] size_t nedges() const;
+
+    /**
+     * Store the sequences of all current and future nodes in 2-bit packed
+     * form (see PackedSequence), roughly quartering the memory used by DNA
+     * sequences. The sequences of all the nodes are packed one after the
+     * other in a single PackedSequence, and views of packed nodes are windows
+     * of it. Nothing is done if the graph is already packed.
+     *
+     * WARNING: Existing views are invalidated.
+     */
+    void pack_sequences();
+
+    /**
+     * Check if the node sequences are stored in 2-bit packed form.
+     *
+     * @return true if the node sequences are packed, false otherwise.
+     */
+    [[nodiscard]] bool is_packed() const;
+
+    /**
+     * Get the approximate number of bytes used by the graph: the nodes, their
+     * edges and their sequences (only the heap buffers of the strings that
+     * do not fit in the string object itself are counted).
+     *
+     * @return The number of bytes used by the graph.
+     */
+    [[nodiscard]] size_t memory_bytes() const;
+
     /**
      * Get NodeIdRange corresponding to the source nodes in the graph. A source
      * node is a node with no incoming edges.
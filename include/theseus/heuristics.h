@@ -27,7 +27,10 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
+#include <limits>
 #include <vector>
 
 #include "theseus/alignment.h"
@@ -48,10 +51,97 @@ namespace theseus {
         Heuristics() {}
 
 
+        // BUDGETS //
+        /**
+         * @brief Stop the alignments whose score exceeds "max_score" with
+         * status THESEUS_STATUS_MAX_STEPS_REACHED. A negative value (default)
+         * sets no limit.
+         *
+         * @param max_score
+         */
+        void set_max_score(int max_score) {
+            _max_score = max_score;
+        }
+
+        /**
+         * @brief Stop the alignments whose score exceeds "max_score_per_base"
+         * times the length of the sequence with status
+         * THESEUS_STATUS_MAX_STEPS_REACHED. A negative value (default) sets no
+         * limit.
+         *
+         * @param max_score_per_base
+         */
+        void set_max_score_per_base(double max_score_per_base) {
+            _max_score_per_base = max_score_per_base;
+        }
+
+        /**
+         * @brief Stop the alignments that keep more than "max_cells" cells in
+         * memory with status THESEUS_STATUS_MAX_STEPS_REACHED. A negative
+         * value (default) sets no limit.
+         *
+         * @param max_cells
+         */
+        void set_max_cells(int64_t max_cells) {
+            _max_cells = max_cells;
+        }
+
+        /**
+         * @brief Whether the alignments stopped by a budget return the
+         * alignment of the furthest cell reached instead of an empty one.
+         *
+         * @param partial_alignment
+         */
+        void set_partial_alignment_on_limit(bool partial_alignment) {
+            _partial_alignment_on_limit = partial_alignment;
+        }
+
+
+        // ADAPTIVE REDUCTION //
+        /**
+         * @brief Adaptive wavefront reduction (as in WFA-adapt). Every
+         * "period" scores, the smallest distance to the end of the query
+         * reached by the cells is updated, and the following cells whose
+         * distance is more than "threshold" above it are pruned. A negative
+         * threshold (default) disables the heuristic.
+         *
+         * @param threshold
+         * @param period
+         */
+        void set_adaptive_reduction(int threshold, int period = 10) {
+            _adaptive_threshold = threshold;
+            _adaptive_period = std::max(1, period);
+        }
+
+
+        // EXTENSION //
+        /**
+         * @brief Extension (X-drop) mode. Each aligned base of the query
+         * scores "match_bonus", so the extension score of a cell is
+         * match_bonus*offset - score. The alignment stops as soon as the
+         * extension score of the furthest cell falls more than "xdrop" below
+         * the best one, and returns the alignment of the best extension with
+         * status THESEUS_STATUS_ALG_PARTIAL. A negative "xdrop" (default)
+         * disables the mode.
+         *
+         * The bonus has to be lower than the score per base of unrelated
+         * sequences (about one with the default penalties) for their
+         * extension score to drop.
+         *
+         * @param xdrop
+         * @param match_bonus
+         */
+        void set_xdrop(int xdrop, double match_bonus = 0.5) {
+            _xdrop = xdrop;
+            _match_bonus = match_bonus;
+        }
+
+
         // INITIALIZER //
         void new_alignment(int gape, int seq_len, bool density_drop_active, bool lag_pruning_active) {
             // General
             _max_offset = 0;
+            _seq_len = seq_len;
             _lag_pruning  = lag_pruning_active;
             _density_drop = density_drop_active;
 
@@ -70,6 +160,21 @@ namespace theseus {
             int min_offsets_to_prune   = std::max(std::min(500, seq_len/20), 50);
             _min_off_increase_to_prune = min_offsets_to_prune*3; // Advance 2 matches per error (33% error rate?)
             _lookback_lag              = min_offsets_to_prune*gape;
+
+            // Adaptive reduction
+            _min_distance    = std::numeric_limits<int>::max();
+            _distance_cutoff = std::numeric_limits<int>::max();
+
+            // Extension
+            _best_extension = std::numeric_limits<double>::lowest();
+            _best_extension_score = -1;
+
+            // Budgets
+            _max_steps = std::numeric_limits<int>::max();
+            if (_max_score >= 0) _max_steps = _max_score;
+            if (_max_score_per_base >= 0) {
+                _max_steps = std::min<double>(_max_steps, _max_score_per_base*seq_len);
+            }
         }
 
 
@@ -83,7 +188,28 @@ namespace theseus {
             if (check_lag_pruning(curr_offset)) {
                 return true;
             }
-            else return false;
+            // Check adaptive reduction
+            return _seq_len - curr_offset > _distance_cutoff;
+        }
+
+        /**
+         * @brief Same as check_local_heuristics, but the max offset is not
+         * updated, so the cells of a wave can be checked concurrently. The
+         * max offset is then updated once with update_max_offset.
+         */
+        bool check_local_heuristics_const(int curr_offset) const {
+            if (_lag_pruning && _pruning_allowed && _max_offset - curr_offset > _min_off_increase_to_prune) {
+                return true;
+            }
+            return _seq_len - curr_offset > _distance_cutoff;
+        }
+
+        /**
+         * @brief Update the max offset with the furthest offset of the cells
+         * checked with check_local_heuristics_const.
+         */
+        void update_max_offset(int offset) {
+            _max_offset = std::max(_max_offset, offset);
         }
 
         /**
@@ -144,6 +270,10 @@ namespace theseus {
             _last_max_offsets[score%_K] = _max_offset;
             // Update pruning condition
             update_pruning_condition(score);
+            // Update the cutoff of the adaptive reduction
+            if (is_adaptive_reduction_active() && score % _adaptive_period == 0) {
+                update_distance_cutoff();
+            }
             // Check advancement density heuristic
             if (_density_drop) return check_density_drop(score);
             return THESEUS_STATUS_OK;
@@ -211,14 +341,68 @@ namespace theseus {
         /**
          * @brief Over steps limit heuristic
          *
-         * Check if we are out of the step limit (the two sequences are too
-         * similar)
+         * Check if the alignment is out of its budget: its score is over the
+         * maximum score (absolute or relative to the length of the sequence)
+         * or it keeps more than the maximum number of cells.
          *
+         * @param score
+         * @param ncells Number of cells kept by the aligner
          */
-        // int is_over_step_limit(int &score) {
-        //     if (!_steps_limit) return THESEUS_STATUS_OK;
-        //     else return score > _max_steps ? THESEUS_STATUS_MAX_STEPS_REACHED : THESEUS_STATUS_OK;
-        // }
+        int is_over_step_limit(int score, int64_t ncells) {
+            if (!is_steps_limit_active()) return THESEUS_STATUS_OK;
+            return (score > _max_steps || (_max_cells >= 0 && ncells > _max_cells)) ?
+                    THESEUS_STATUS_MAX_STEPS_REACHED :
+                    THESEUS_STATUS_OK;
+        }
+
+
+        /**
+         * @brief Adaptive reduction
+         *
+         * Let "distance" indicate the number of bases of the query left to
+         * align from a cell, and "min_distance" the smallest distance among
+         * the cells computed (and extended) in the last period. A new cell is
+         * pruned if
+         *                  distance - min_distance > threshold
+         * -----------
+         * Offsets in different vertices are comparable (they are positions of
+         * the query), while the bases left in the graph are not: the column
+         * is reset at every vertex, so only the query is considered.
+         *
+         * @param offset Offset of a cell after its extension
+         */
+        inline void update_min_distance(int offset) {
+            _min_distance = std::min(_min_distance, _seq_len - offset);
+        }
+
+        void update_distance_cutoff() {
+            if (_min_distance == std::numeric_limits<int>::max()) return;
+            _distance_cutoff = _min_distance + _adaptive_threshold;
+            _min_distance = std::numeric_limits<int>::max();
+        }
+
+        /**
+         * @brief X-drop heuristic
+         *
+         * Let "max_offset" indicate the maximum offset reached up to score
+         * "score" (after the extension of the cells). Its extension score is
+         * match_bonus*max_offset - score. If it improves the best extension
+         * score, the best extension is updated. If it is more than "xdrop"
+         * below the best extension score, the extension stops.
+         *
+         * @param score
+         * @param max_offset
+         */
+        int check_xdrop(int score, int max_offset) {
+            const double extension = _match_bonus*max_offset - score;
+            if (extension > _best_extension) {
+                _best_extension = extension;
+                _best_extension_score = score;
+            }
+            return (extension < _best_extension - _xdrop) ?
+                    THESEUS_STATUS_ALG_PARTIAL :
+                    THESEUS_STATUS_OK;
+        }
 
 
         //---------------------------- ACCESSORS -------------------------------
@@ -256,12 +440,55 @@ namespace theseus {
         }
 
         /**
-         * @brief Return maximum number of steps
+         * @brief Return whether any budget is set
          *
          */
-        // int max_steps() {
-        //     return _max_steps;
-        // }
+        bool is_steps_limit_active() {
+            return _max_score >= 0 || _max_score_per_base >= 0 || _max_cells >= 0;
+        }
+
+        /**
+         * @brief Return maximum number of steps (the maximum score of the
+         * current alignment)
+         *
+         */
+        int max_steps() {
+            return _max_steps;
+        }
+
+        /**
+         * @brief Return whether the adaptive reduction is active
+         *
+         */
+        bool is_adaptive_reduction_active() {
+            return _adaptive_threshold >= 0;
+        }
+
+        /**
+         * @brief Return whether the X-drop extension mode is active
+         *
+         */
+        bool is_xdrop_active() {
+            return _xdrop >= 0;
+        }
+
+        /**
+         * @brief Return the score of the best extension of the current
+         * alignment (-1 before the first check)
+         *
+         */
+        int best_extension_score() {
+            return _best_extension_score;
+        }
+
+        /**
+         * @brief Return whether a partial alignment is computed when a budget
+         * is exceeded
+         *
+         */
+        bool partial_alignment_on_limit() {
+            return _partial_alignment_on_limit;
+        }
 
     private:
         // Used heuristics
@@ -270,6 +497,7 @@ namespace theseus {
 
         // General data
         int _max_offset;
+        int _seq_len;
 
         // Lag pruning
         int  _lookback_lag;
@@ -281,6 +509,25 @@ namespace theseus {
         // Density drop heuristic
         int _s_min;
         int _offsets_to_drop;
+
+        // Budgets (negative values set no limit)
+        int     _max_score          = -1;
+        double  _max_score_per_base = -1;
+        int64_t _max_cells          = -1;
+        bool    _partial_alignment_on_limit = false;
+        int     _max_steps   = std::numeric_limits<int>::max();
+
+        // Adaptive reduction (a negative threshold disables it)
+        int _adaptive_threshold = -1;
+        int _adaptive_period    = 10;
+        int _min_distance       = std::numeric_limits<int>::max();
+        int _distance_cutoff    = std::numeric_limits<int>::max();
+
+        // Extension (a negative X-drop disables it)
+        int    _xdrop       = -1;
+        double _match_bonus = 0.5;
+        double _best_extension       = std::numeric_limits<double>::lowest();
+        int    _best_extension_score = -1;
     };
 
 } // namespace theseus
\ No newline at end of file
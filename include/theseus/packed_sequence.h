@@ -0,0 +1,279 @@
+/*
+ *                             The MIT License
+ *
+ * Copyright (c) 2024 by Albert Jimenez-Blanco
+ *
+ * This file is part of #################### Theseus Library ####################.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * Nucleotide sequence stored with 2 bits per base (A=0, C=1, G=2, T=3), 32
+ * bases per 64-bit word. Characters outside of the {A, C, G, T} alphabet (N,
+ * IUPAC codes, lowercase bases...) are exceptions: their position is flagged
+ * in an exception bit mask and their original character is kept aside, so the
+ * original sequence can always be recovered exactly. The exception mask is only
+ * allocated once the first exception is found, so plain DNA costs 2 bits per
+ * base.
+ *
+ * The raw accessors (bases, exceptions) return 32 consecutive positions at a
+ * time and are meant to be used by word-at-a-time comparison kernels.
+ *
+ */
+
+namespace theseus {
+
+class PackedSequence {
+public:
+    static constexpr int bases_per_word = 32;
+
+    /**
+     * Construct an empty packed sequence.
+     *
+     */
+    PackedSequence() = default;
+
+    /**
+     * Construct a packed sequence from the given characters.
+     *
+     * @param seq The sequence to pack.
+     */
+    explicit PackedSequence(std::string_view seq);
+
+    /**
+     * Replace the contents of the packed sequence with the given characters.
+     *
+     * @param seq The sequence to pack.
+     */
+    void assign(std::string_view seq);
+
+    /**
+     * Append the given characters at the end of the packed sequence.
+     *
+     * @param seq The suffix to append.
+     */
+    void append(std::string_view seq);
+
+    /**
+     * Shrink the packed sequence to its first @p new_size bases. Nothing is
+     * done if @p new_size is not smaller than the current size.
+     *
+     * @param new_size The new size of the sequence.
+     */
+    void truncate(size_t new_size);
+
+    /**
+     * Unpack the bases [pos, pos + count) into a string, stopping at the end
+     * of the sequence.
+     *
+     * @param pos First position to unpack.
+     * @param count Maximum number of bases to unpack.
+     * @return The unpacked bases.
+     */
+    [[nodiscard]] std::string unpack(size_t pos = 0, size_t count = std::string::npos) const;
+
+    /**
+     * Get the number of bases of the sequence.
+     *
+     * @return The number of bases of the sequence.
+     */
+    [[nodiscard]] size_t size() const noexcept { return size_; }
+
+    /**
+     * Check if the sequence is empty.
+     *
+     * @return true if the sequence has no bases, false otherwise.
+     */
+    [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+    /**
+     * Check if the sequence contains characters outside of {A, C, G, T}.
+     *
+     * @return true if the sequence contains exceptions, false otherwise.
+     */
+    [[nodiscard]] bool has_exceptions() const noexcept { return !exceptions_.empty(); }
+
+    /**
+     * Get the character at the given position.
+     *
+     * @param idx Position in [0, size()).
+     * @return The character at the given position.
+     */
+    [[nodiscard]] char operator[](size_t idx) const {
+        if (has_exceptions() && ((exception_mask_[idx / 64] >> (idx % 64)) & 1)) {
+            return exception_at(idx);
+        }
+        return decode((words_[idx / bases_per_word] >> (2 * (idx % bases_per_word))) & 3);
+    }
+
+    /**
+     * Get the character at the given position of the reverse complement of
+     * the sequence, without materializing it. Exceptions are complemented
+     * following the IUPAC convention when possible and returned unchanged
+     * otherwise.
+     *
+     * @param idx Position in [0, size()) of the reverse complement.
+     * @return The character at the given position of the reverse complement.
+     */
+    [[nodiscard]] char reverse_complement_at(size_t idx) const {
+        return complement((*this)[size_ - 1 - idx]);
+    }
+
+    /**
+     * Get the 2-bit codes of the bases [pos, pos + 32), base "pos" in the
+     * lowest bits. Positions past the end of the sequence hold unspecified
+     * values, and so do exception positions.
+     *
+     * @param pos First position of the block.
+     * @return 32 packed 2-bit codes.
+     */
+    [[nodiscard]] uint64_t bases(size_t pos) const {
+        const size_t w = pos / bases_per_word;
+        const unsigned s = 2 * (pos % bases_per_word);
+        uint64_t word = words_[w] >> s;
+        if (s != 0) {
+            word |= words_[w + 1] << (64 - s);
+        }
+        return word;
+    }
+
+    /**
+     * Get the exception flags of the positions [pos, pos + 32), position
+     * "pos" in the lowest bit.
+     *
+     * @param pos First position of the block.
+     * @return 32 exception flags.
+     */
+    [[nodiscard]] uint32_t exceptions(size_t pos) const {
+        if (!has_exceptions()) {
+            return 0;
+        }
+        const size_t w = pos / 64;
+        const unsigned s = pos % 64;
+        uint64_t word = exception_mask_[w] >> s;
+        if (s != 0) {
+            word |= exception_mask_[w + 1] << (64 - s);
+        }
+        return static_cast<uint32_t>(word);
+    }
+
+    /**
+     * Get the number of bytes used to store the sequence.
+     *
+     * @return The number of bytes used to store the sequence.
+     */
+    [[nodiscard]] size_t memory_bytes() const noexcept {
+        return words_.capacity() * sizeof(uint64_t) +
+               exception_mask_.capacity() * sizeof(uint64_t) +
+               exceptions_.capacity() * sizeof(std::pair<uint64_t, char>);
+    }
+
+    /**
+     * Get the 2-bit code of a character, or -1 if it is an exception.
+     *
+     * @param c The character to encode.
+     * @return The 2-bit code of the character, or -1.
+     */
+    static constexpr int encode(char c) {
+        switch (c) {
+            case 'A': return 0;
+            case 'C': return 1;
+            case 'G': return 2;
+            case 'T': return 3;
+            default:  return -1;
+        }
+    }
+
+    /**
+     * Get the character of a 2-bit code.
+     *
+     * @param code The 2-bit code.
+     * @return The character of the code.
+     */
+    static constexpr char decode(uint64_t code) {
+        return "ACGT"[code];
+    }
+
+    /**
+     * Get the complement of a nucleotide (IUPAC codes included). Unknown
+     * characters are returned unchanged.
+     *
+     * @param c The character to complement.
+     * @return The complemented character.
+     */
+    static constexpr char complement(char c) {
+        switch (c) {
+            case 'A': return 'T';  case 'a': return 't';
+            case 'C': return 'G';  case 'c': return 'g';
+            case 'G': return 'C';  case 'g': return 'c';
+            case 'T': return 'A';  case 't': return 'a';
+            case 'R': return 'Y';  case 'r': return 'y';
+            case 'Y': return 'R';  case 'y': return 'r';
+            case 'K': return 'M';  case 'k': return 'm';
+            case 'M': return 'K';  case 'm': return 'k';
+            case 'B': return 'V';  case 'b': return 'v';
+            case 'V': return 'B';  case 'v': return 'b';
+            case 'D': return 'H';  case 'd': return 'h';
+            case 'H': return 'D';  case 'h': return 'd';
+            default:  return c;
+        }
+    }
+
+private:
+    /**
+     * Get the original character of an exception position.
+     *
+     * @param idx Position of the exception.
+     * @return The original character.
+     */
+    char exception_at(size_t idx) const {
+        auto it = std::lower_bound(exceptions_.begin(), exceptions_.end(), idx,
+                                   [](const std::pair<uint64_t, char> &e, size_t pos) {
+                                       return e.first < pos;
+                                   });
+        return it->second;
+    }
+
+    // 2-bit codes, plus one padding word so that bases() can always read the
+    // next word.
+    std::vector<uint64_t> words_;
+    // One bit per position (plus one padding word). Empty if there are no
+    // exceptions.
+    std::vector<uint64_t> exception_mask_;
+    // Sorted (position, character) pairs of the exception positions.
+    std::vector<std::pair<uint64_t, char>> exceptions_;
+
+    size_t size_ = 0;
+};
+
+}  // namespace theseus
@@ -30,12 +30,17 @@
 
 #include <memory>
 #include <istream>
+#include <span>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 
 #include "theseus/graph.h"
 #include "theseus/penalties.h"
 #include "theseus/alignment.h"
 #include "theseus/heuristics.h"
+#include "theseus/aligner_index.h"
+#include "theseus/aligner_workspace.h"
 
 
 /**
@@ -51,7 +56,7 @@ namespace theseus
 {
     using NodeId = Graph::NodeId;
 
-    class TheseusAlignerImpl; // Forward declaration of the implementation class.
+    class WavePool; // Forward declaration of the thread pool.
 
     class TheseusAligner
     {
@@ -107,16 +112,145 @@ namespace theseus
          * @param seq Sequence to be aligned
          * @param start_node Starting node in the graph
          * @param start_offset Starting offset within the starting node
+         * @param ends_free Ends-free options (by default, the whole sequence
+         *                  is aligned and the alignment may end anywhere in
+         *                  the graph)
          * @return Alignment
          */
         Alignment align(std::string_view seq,
                         NodeId &start_node,
                         int start_offset = 0,
                         bool density_drop_active = false,
-                        bool lag_pruning_active = false);
+                        bool lag_pruning_active = false,
+                        EndsFree ends_free = {});
+
+        /**
+         * Same as align, but the result is written into the given alignment,
+         * reusing its buffers. Once the buffers of the alignment and of the
+         * aligner are large enough (e.g. after aligning a few sequences),
+         * aligning does not allocate memory.
+         *
+         * @param alignment Output alignment (its previous contents are discarded)
+         * @param seq Sequence to be aligned
+         * @param start_node Starting node in the graph
+         * @param start_offset Starting offset within the starting node
+         * @param ends_free Ends-free options
+         */
+        void align_into(Alignment &alignment,
+                        std::string_view seq,
+                        NodeId start_node,
+                        int start_offset = 0,
+                        bool density_drop_active = false,
+                        bool lag_pruning_active = false,
+                        EndsFree ends_free = {});
+
+        /**
+         * Align a batch of sequences on several threads. All the threads share
+         * the AlignerIndex of the aligner, and each one aligns with its own
+         * AlignerWorkspace. The threads and their workspaces are kept for the
+         * following batches with the same number of threads. The threads take
+         * the next unaligned sequence as soon as they finish one, so long and
+         * short sequences are balanced among them. The heuristics, checkpoint
+         * interval and parallel wave of the aligner apply to all of them, so
+         * the alignments are the same as those of align_into, and they are
+         * returned in the order of the input.
+         *
+         * @param seqs Sequences to be aligned
+         * @param start_nodes Starting node of each sequence
+         * @param start_offsets Starting offset of each sequence
+         * @param num_threads Number of threads (0 uses one per hardware thread)
+         * @param ends_free Ends-free options
+         * @return Alignments, in the order of seqs
+         */
+        std::vector<Alignment> align_batch(std::span<const std::string_view> seqs,
+                                           std::span<const NodeId> start_nodes,
+                                           std::span<const int> start_offsets,
+                                           int num_threads = 0,
+                                           bool density_drop_active = false,
+                                           bool lag_pruning_active = false,
+                                           EndsFree ends_free = {});
+
+        /**
+         * Compute only the score and the end position of the alignment of the
+         * given sequence. No backtrace is performed, so the cells computed are
+         * released as soon as they leave the scope, and the memory depends on
+         * the width of the wavefronts instead of on the length of the sequence.
+         *
+         * @param seq Sequence to be aligned
+         * @param start_node Starting node in the graph
+         * @param start_offset Starting offset within the starting node
+         * @param ends_free Ends-free options
+         * @return AlignmentScore
+         */
+        AlignmentScore align_score(std::string_view seq,
+                                   NodeId start_node,
+                                   int start_offset = 0,
+                                   bool density_drop_active = false,
+                                   bool lag_pruning_active = false,
+                                   EndsFree ends_free = {});
+
+        /**
+         * Align the given sequence from the starting position to the end
+         * found by align_score, with memory that grows with the score instead
+         * of with the square of the score. The sequence is split where a
+         * forward and a reverse half-alignment meet, and both halves are
+         * aligned recursively, which takes a few times longer than align.
+         * The alignment is optimal, but among alignments with the same score
+         * another one than the one returned by align may be chosen. No
+         * heuristics are applied.
+         *
+         * @param seq Sequence to be aligned
+         * @param start_node Starting node in the graph
+         * @param start_offset Starting offset within the starting node
+         * @return Alignment
+         */
+        Alignment align_bidirectional(std::string_view seq,
+                                      NodeId start_node,
+                                      int start_offset = 0);
+
+        /**
+         * Replace the heuristics used by the following alignments, e.g. to
+         * change the budgets (maximum score and maximum number of cells kept)
+         * of each call. The alignments that exceed a budget stop with status
+         * THESEUS_STATUS_MAX_STEPS_REACHED.
+         *
+         * @param heuristics Heuristics object
+         */
+        void set_heuristics(const Heuristics &heuristics);
+
+        /**
+         * Trade time for memory in align and align_into. With an interval k
+         * greater than zero, only the cells of every k-th score (and of the
+         * few scores before it) are kept while aligning, and the backtrace
+         * recomputes the segments of the alignment between these checkpoints.
+         * For an alignment of score s, the memory is about that of s/k scores
+         * for the checkpoints plus that of k scores for a segment, so a k close
+         * to the square root of the expected score gives the lowest memory, at
+         * the cost of about two more passes over the alignment. Zero (the
+         * default) keeps all the cells.
+         *
+         * @param interval Number of scores between checkpoints (0 disables them)
+         */
+        void set_checkpoint_interval(int interval);
+
+        /**
+         * Compute each alignment on several threads, for long sequences whose
+         * wavefronts span many vertices of the graph. The next wavefronts of
+         * the vertices of a score are computed concurrently, and the jumps
+         * between vertices are then followed in a fixed order, so the result
+         * does not depend on the number of threads. The score is the same as
+         * with a single thread, but ties may be broken differently and some
+         * more cells may be computed. align_batch uses it on every thread of
+         * the batch.
+         *
+         * @param num_threads Number of threads (0 or 1 computes each alignment on the calling thread)
+         */
+        void set_parallel_wave(int num_threads);
 
     private:
-        std::unique_ptr<TheseusAlignerImpl> aligner_impl_;
+        std::shared_ptr<const AlignerIndex> index_;
+        std::vector<AlignerWorkspace> workspaces_;  // One per thread of align_batch, the first one is the calling thread's
+        std::unique_ptr<WavePool> batch_pool_;      // Threads of align_batch (null until a batch uses several)
     };
 
 } // namespace theseus
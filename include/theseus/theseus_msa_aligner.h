@@ -89,6 +89,54 @@ namespace theseus
          */
         Alignment align_only(std::string_view seq);
 
+        /**
+         * Compute only the score and the end position of the alignment of a
+         * sequence against the current POA graph, without mutating it and
+         * without keeping the cells needed for backtrace.
+         *
+         * @param seq
+         * @return AlignmentScore
+         */
+        AlignmentScore align_score(std::string_view seq);
+
+        /**
+         * Add a new sequence to the POA graph like align, but computing the
+         * alignment with memory that grows with the score instead of with the
+         * square of the score (see TheseusAligner::align_bidirectional).
+         * Suitable for long sequences.
+         *
+         * @param seq Sequence to add to the MSA
+         * @return Alignment
+         */
+        Alignment align_bidirectional(std::string_view seq,
+                                      int weight = 1);
+
+        /**
+         * Replace the heuristics used by the following alignments (see
+         * TheseusAligner::set_heuristics).
+         *
+         * @param heuristics Heuristics object
+         */
+        void set_heuristics(const Heuristics &heuristics);
+
+        /**
+         * Keep only the cells of every "interval" scores during align, and
+         * recompute the segments between them during the backtrace (see
+         * TheseusAligner::set_checkpoint_interval). Reverse alignments always
+         * keep all the cells.
+         *
+         * @param interval Number of scores between checkpoints (0 disables them)
+         */
+        void set_checkpoint_interval(int interval);
+
+        /**
+         * Compute each alignment on several threads (see
+         * TheseusAligner::set_parallel_wave).
+         *
+         * @param num_threads Number of threads (0 or 1 computes each alignment on the calling thread)
+         */
+        void set_parallel_wave(int num_threads);
+
         /**
          * @brief Print the current POA graph as a GFA file.
          *
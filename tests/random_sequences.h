@@ -0,0 +1,130 @@
+/*
+ *                             The MIT License
+ *
+ * Copyright (c) 2024 by Albert Jimenez-Blanco
+ *
+ * This file is part of #################### Theseus Library ####################.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+
+#pragma once
+
+#include <random>
+#include <string>
+
+#include "../include/theseus/graph.h"
+
+/**
+ * Random DNA sequences and graphs shared by the unit tests. The helpers draw
+ * from the generator of the test, so each test keeps its own seed.
+ *
+ */
+
+namespace theseus_tests {
+
+/**
+ * Random sequence of A, C, G and T.
+ *
+ * @param rng Generator of the test
+ * @param length Length of the sequence
+ * @return std::string
+ */
+inline std::string random_sequence(std::mt19937 &rng, size_t length) {
+    static constexpr char bases[] = {'A', 'C', 'G', 'T'};
+    std::string seq;
+    seq.reserve(length);
+    for (size_t i = 0; i < length; ++i) seq.push_back(bases[rng() % 4]);
+    return seq;
+}
+
+/**
+ * Copy of a sequence with random edits. Each position is replaced by a random
+ * base, deleted or followed by a random base with the given percentages.
+ *
+ * @param seq Original sequence
+ * @param rng Generator of the test
+ * @param mismatch_rate Percentage of positions replaced
+ * @param deletion_rate Percentage of positions deleted
+ * @param insertion_rate Percentage of positions followed by an insertion
+ * @return std::string
+ */
+inline std::string mutate(const std::string &seq, std::mt19937 &rng,
+                          int mismatch_rate, int deletion_rate, int insertion_rate) {
+    static constexpr char bases[] = {'A', 'C', 'G', 'T'};
+    std::string out;
+    out.reserve(seq.size() + seq.size() * insertion_rate / 100 + 1);
+    for (char c : seq) {
+        const int r = rng() % 100;
+        if (r < mismatch_rate) out.push_back(bases[rng() % 4]);
+        else if (r < mismatch_rate + deletion_rate) continue;
+        else if (r < mismatch_rate + deletion_rate + insertion_rate) { out.push_back(c); out.push_back(bases[rng() % 4]); }
+        else out.push_back(c);
+    }
+    return out;
+}
+
+/**
+ * Graph made of a chain of bubbles, and the sequence of one of its paths.
+ *
+ */
+struct BubbleChain {
+    theseus::Graph graph;
+    std::string reference;          // Sequence of the path through the first allele of each bubble
+    theseus::Graph::NodeId first;   // First node of the chain
+};
+
+/**
+ * Random chain of bubbles. The chain starts with a node of joint_length
+ * bases, and each bubble has two alleles (of allele_length and other_length
+ * bases) followed by a joint node. All the sequences are random.
+ *
+ * @param rng Generator of the test
+ * @param nbubbles Number of bubbles
+ * @param allele_length Length of the first allele of each bubble
+ * @param other_length Length of the second allele of each bubble
+ * @param joint_length Length of the nodes between the bubbles
+ * @return BubbleChain
+ */
+inline BubbleChain bubble_chain(std::mt19937 &rng, int nbubbles,
+                                size_t allele_length, size_t other_length, size_t joint_length) {
+    BubbleChain chain;
+    chain.reference = random_sequence(rng, joint_length);
+    chain.first = chain.graph.add_node(chain.reference);
+    theseus::Graph::NodeId prev = chain.first;
+    for (int b = 0; b < nbubbles; ++b) {
+        std::string allele = random_sequence(rng, allele_length);
+        std::string other = random_sequence(rng, other_length);
+        std::string joint = random_sequence(rng, joint_length);
+        chain.reference += allele + joint;
+        const theseus::Graph::NodeId n1 = chain.graph.add_node(std::move(allele));
+        const theseus::Graph::NodeId n2 = chain.graph.add_node(std::move(other));
+        const theseus::Graph::NodeId n3 = chain.graph.add_node(std::move(joint));
+        chain.graph.add_edge(prev, n1);
+        chain.graph.add_edge(prev, n2);
+        chain.graph.add_edge(n1, n3);
+        chain.graph.add_edge(n2, n3);
+        prev = n3;
+    }
+    return chain;
+}
+
+} // namespace theseus_tests
@@ -0,0 +1,125 @@
+/*
+ *                             The MIT License
+ *
+ * Copyright (c) 2024 by Albert Jimenez-Blanco
+ *
+ * This file is part of #################### Theseus Library ####################.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+
+#include "../doctest.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../../include/theseus/graph.h"
+#include "../../include/theseus/alignment.h"
+#include "../../include/theseus/penalties.h"
+#include "../../include/theseus/theseus_aligner.h"
+#include "../random_sequences.h"
+
+// Count the heap allocations performed while "counting" is set
+static std::atomic<bool> counting{false};
+static std::atomic<long> nallocations{0};
+
+void *operator new(std::size_t size) {
+    if (counting) nallocations += 1;
+    if (void *ptr = std::malloc(size == 0 ? 1 : size)) return ptr;
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void *operator new(std::size_t size, std::align_val_t align) {
+    if (counting) nallocations += 1;
+    const std::size_t alignment = static_cast<std::size_t>(align);
+    if (void *ptr = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment)) return ptr;
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size, std::align_val_t align) {
+    return operator new(size, align);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+    if (counting) nallocations += 1;
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &tag) noexcept {
+    return operator new(size, tag);
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, const std::nothrow_t &) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept { std::free(ptr); }
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+
+using NodeId = theseus::Graph::NodeId;
+
+TEST_CASE("Steady-state alignments do not allocate") {
+    std::mt19937 gen(7);
+
+    // Chain of bubbles
+    theseus_tests::BubbleChain chain = theseus_tests::bubble_chain(gen, 10, 5, 6, 20);
+    const NodeId first = chain.first;
+
+    theseus::Penalties penalties(0, 2, 3, 1);
+    theseus::Heuristics heuristics;
+    theseus::TheseusAligner aligner(penalties, heuristics, chain.graph);
+
+    std::vector<std::string> reads;
+    for (int l = 0; l < 20; ++l) reads.push_back(theseus_tests::mutate(chain.reference, gen, 3, 2, 2));
+
+    // Warm up the buffers of the aligner and the output alignment
+    theseus::Alignment alignment;
+    for (const auto &read : reads) {
+        aligner.align_into(alignment, read, first, 0);
+    }
+
+    for (const auto &read : reads) {
+        NodeId start = first;
+        const theseus::Alignment expected = aligner.align(read, start, 0);
+
+        nallocations = 0;
+        counting = true;
+        aligner.align_into(alignment, read, first, 0);
+        counting = false;
+
+        CHECK(nallocations.load() == 0);
+        CHECK(alignment.theseus_status == expected.theseus_status);
+        CHECK(alignment.cigar == expected.cigar);
+        CHECK(alignment.path == expected.path);
+    }
+}
@@ -0,0 +1,144 @@
+/*
+ *                             The MIT License
+ *
+ * Copyright (c) 2024 by Albert Jimenez-Blanco
+ *
+ * This file is part of #################### Theseus Library ####################.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+
+#include "../doctest.h"
+
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../include/theseus/graph.h"
+#include "../../include/theseus/alignment.h"
+#include "../../include/theseus/penalties.h"
+#include "../../include/theseus/aligner_index.h"
+#include "../../include/theseus/aligner_workspace.h"
+#include "../../include/theseus/theseus_aligner.h"
+#include "../random_sequences.h"
+
+using NodeId = theseus::Graph::NodeId;
+
+TEST_CASE("Workspaces share an aligner index") {
+    std::mt19937 gen(11);
+
+    // Chain of bubbles
+    theseus_tests::BubbleChain chain = theseus_tests::bubble_chain(gen, 10, 5, 6, 20);
+    theseus::Graph &G = chain.graph;
+    const NodeId first = chain.first;
+
+    theseus::Penalties penalties(0, 2, 3, 1);
+    theseus::Heuristics heuristics;
+    theseus::TheseusAligner aligner(penalties, heuristics, G);
+    auto index = std::make_shared<const theseus::AlignerIndex>(penalties, G);
+
+    std::vector<std::string> reads;
+    for (int l = 0; l < 40; ++l) reads.push_back(theseus_tests::mutate(chain.reference, gen, 3, 2, 2));
+    std::vector<theseus::Alignment> expected;
+    for (const auto &read : reads) {
+        NodeId start = first;
+        expected.push_back(aligner.align(read, start, 0));
+    }
+
+    SUBCASE("Same alignments as TheseusAligner") {
+        theseus::AlignerWorkspace workspace(index, heuristics);
+        CHECK(workspace.index() == index);
+        for (size_t r = 0; r < reads.size(); ++r) {
+            theseus::Alignment alignment = workspace.align(reads[r], first, 0);
+            CHECK(alignment.cigar == expected[r].cigar);
+            CHECK(alignment.path == expected[r].path);
+            theseus::AlignmentScore score = workspace.align_score(reads[r], first, 0);
+            CHECK(score.score == expected[r].compute_affine_gap_score(penalties));
+        }
+    }
+
+    SUBCASE("Concurrent workspaces") {
+        // Each thread aligns all the reads with its own workspace, starting at a different read
+        const int nthreads = 4;
+        std::vector<std::vector<theseus::Alignment>> results(nthreads);
+        {
+            std::vector<std::jthread> threads;
+            for (int t = 0; t < nthreads; ++t) {
+                threads.emplace_back([&, t]() {
+                    theseus::AlignerWorkspace workspace(index, heuristics);
+                    results[t].resize(reads.size());
+                    for (size_t i = 0; i < reads.size(); ++i) {
+                        const size_t r = (i + t * 10) % reads.size();
+                        workspace.align_into(results[t][r], reads[r], first, 0);
+                    }
+                });
+            }
+        }
+        for (int t = 0; t < nthreads; ++t) {
+            for (size_t r = 0; r < reads.size(); ++r) {
+                CHECK(results[t][r].theseus_status == expected[r].theseus_status);
+                CHECK(results[t][r].cigar == expected[r].cigar);
+                CHECK(results[t][r].path == expected[r].path);
+            }
+        }
+    }
+
+    SUBCASE("Batch of alignments") {
+        // Every read twice, the second copies in reverse order and starting one base later
+        std::vector<std::string_view> seqs;
+        std::vector<NodeId> start_nodes;
+        std::vector<int> start_offsets;
+        for (size_t r = 0; r < reads.size(); ++r) {
+            seqs.push_back(reads[r]);
+            start_nodes.push_back(first);
+            start_offsets.push_back(0);
+        }
+        for (size_t r = reads.size(); r-- > 0;) {
+            seqs.push_back(reads[r]);
+            start_nodes.push_back(first);
+            start_offsets.push_back(r % 2);
+        }
+
+        theseus::AlignerWorkspace workspace(index, heuristics);
+        std::vector<theseus::Alignment> alignments(seqs.size());
+        workspace.align_batch_into(alignments, seqs, start_nodes, start_offsets);
+        for (size_t i = 0; i < seqs.size(); ++i) {
+            theseus::Alignment alignment = workspace.align(seqs[i], start_nodes[i], start_offsets[i]);
+            CHECK(alignments[i].cigar == alignment.cigar);
+            CHECK(alignments[i].path == alignment.path);
+            CHECK(alignments[i].start_offset == alignment.start_offset);
+        }
+        for (size_t r = 0; r < reads.size(); ++r) {
+            CHECK(alignments[r].cigar == expected[r].cigar);
+        }
+
+        start_offsets.pop_back();
+        CHECK_THROWS_AS(workspace.align_batch_into(alignments, seqs, start_nodes, start_offsets),
+                        std::invalid_argument);
+    }
+
+    SUBCASE("Unsupported penalties are rejected by the index") {
+        theseus::Penalties dual_penalties(0, 4, 6, 2, 24, 1);
+        CHECK_THROWS_AS(theseus::AlignerIndex(dual_penalties, theseus::Graph()), std::invalid_argument);
+    }
+}
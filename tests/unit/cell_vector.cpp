@@ -0,0 +1,102 @@
+/*
+ *                             The MIT License
+ *
+ * Copyright (c) 2024 by Albert Jimenez-Blanco
+ *
+ * This file is part of #################### Theseus Library ####################.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+
+
+#include "../doctest.h"
+
+#include <cstdint>
+
+#include "../../theseus/cell.h"
+
+using theseus::Cell;
+
+static bool same_cell(const Cell &a, const Cell &b) {
+    return a.prev_pos == b.prev_pos && a.vertex_id == b.vertex_id &&
+           a.offset == b.offset && a.diag == b.diag && a.from_matrix == b.from_matrix;
+}
+
+TEST_CASE("Cell vectors") {
+    Cell::CellVector cells;
+    cells.realloc(4);
+    cells.set_realloc_policy([](std::ptrdiff_t, std::ptrdiff_t required) { return required * 2; });
+
+    SUBCASE("Cells are stored by columns") {
+        for (int l = 0; l < 10; ++l) {
+            cells.push_back(Cell{l - 1, static_cast<Cell::vertex_t>(l), l, -l, Cell::Matrix::M});
+        }
+        CHECK(cells.size() == 10);
+        cells.offset(3) += 5;
+        CHECK(same_cell(cells[3], Cell{2, 3, 8, -3, Cell::Matrix::M}));
+        CHECK(cells.offsets()[3] == 8);
+        CHECK(cells.diags()[9] == -9);
+    }
+
+    SUBCASE("Narrow cells are promoted when they overflow") {
+        cells.set_narrow(true);
+        CHECK(cells.is_narrow());
+        cells.push_back(Cell{-1, 7, 0, 2, Cell::Matrix::MJumps});
+        cells.push_back(Cell{0, 8, 1, 3, Cell::Matrix::M});
+        CHECK(cells.is_narrow());
+
+        const Cell big_vertex{1, Cell::vertex_t{1} << 40, 2, 4, Cell::Matrix::I};
+        cells.push_back(big_vertex);
+        CHECK(!cells.is_narrow());
+        CHECK(same_cell(cells[0], Cell{-1, 7, 0, 2, Cell::Matrix::MJumps}));
+        CHECK(same_cell(cells[1], Cell{0, 8, 1, 3, Cell::Matrix::M}));
+        CHECK(same_cell(cells[2], big_vertex));
+
+        cells.clear();
+        cells.set_narrow(true);
+        const Cell big_pos{Cell::pos_t{1} << 35, 1, 2, 4, Cell::Matrix::IJumps};
+        cells.push_back(big_pos);
+        CHECK(!cells.is_narrow());
+        CHECK(same_cell(cells[0], big_pos));
+    }
+
+    SUBCASE("Discarded cells keep the positions of the rest") {
+        for (bool narrow : {true, false}) {
+            cells.clear();
+            cells.set_narrow(narrow);
+            for (int l = 0; l < 10; ++l) {
+                cells.push_back(Cell{l - 1, static_cast<Cell::vertex_t>(l), l, -l, Cell::Matrix::M});
+            }
+            cells.discard_front(6);
+            CHECK(cells.origin() == 6);
+            CHECK(cells.size() == 10);
+            CHECK(same_cell(cells[7], Cell{6, 7, 7, -7, Cell::Matrix::M}));
+            CHECK(cells.offsets()[0] == 6);
+            cells.push_back(Cell{9, 10, 10, -10, Cell::Matrix::M});
+            CHECK(same_cell(cells[10], Cell{9, 10, 10, -10, Cell::Matrix::M}));
+            cells.discard_front(3);  // Already discarded
+            CHECK(cells.origin() == 6);
+            cells.clear();
+            CHECK(cells.origin() == 0);
+            CHECK(cells.empty());
+        }
+    }
+}
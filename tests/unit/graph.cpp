@@ -0,0 +1,95 @@
+/*
+ *                             The MIT License
+ *
+ * Copyright (c) 2024 by Albert Jimenez-Blanco
+ *
+ * This file is part of #################### Theseus Library ####################.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+
+#include "../doctest.h"
+
+#include <algorithm>
+#include <string>
+
+#include "../../include/theseus/graph.h"
+
+// Reference values computed by scanning the graph
+static void check_stats(const theseus::Graph &graph) {
+    int max_size = 0;
+    size_t total_length = 0, nedges = 0;
+    for (auto id : graph.nodes()) {
+        max_size = std::max(max_size, graph.node_size(id));
+        total_length += graph.node_size(id);
+        for ([[maybe_unused]] auto out : graph.node(id).out_nodes) nedges += 1;
+    }
+    CHECK(graph.max_node_size() == max_size);
+    CHECK(graph.total_sequence_length() == total_length);
+    CHECK(graph.nedges() == nedges);
+}
+
+TEST_CASE("Graph size statistics") {
+    theseus::Graph graph;
+    check_stats(graph);
+
+    auto a = graph.add_node("ACGTACGT");
+    auto b = graph.add_node("ACGTACGT");
+    auto c = graph.add_node("AC");
+    graph.add_edge(a, b);
+    graph.add_edge(b, c);
+    graph.add_edge(a, c);
+    graph.add_edge(c, c);
+    check_stats(graph);
+
+    SUBCASE("Split the longest nodes") {
+        graph.split_sequence(a, 3);
+        check_stats(graph);
+        graph.split_sequence(b, 5);
+        check_stats(graph);
+        graph.expand_sequence(c, "GGGG");
+        check_stats(graph);
+    }
+
+    SUBCASE("Remove nodes and edges") {
+        graph.remove_edge(a, c);
+        check_stats(graph);
+        graph.remove_node(c);
+        check_stats(graph);
+        graph.remove_node(a);
+        check_stats(graph);
+        graph.remove_in_edges(b);
+        graph.remove_node(b);
+        check_stats(graph);
+        auto d = graph.add_node("ACG");
+        CHECK(graph.node_size(d) == 3);
+        check_stats(graph);
+    }
+
+    SUBCASE("Packed graph") {
+        graph.pack_sequences();
+        graph.split_sequence(a, 2);
+        graph.split_sequence(b, 2);
+        check_stats(graph);
+        graph.expand_sequence(c, "TTTTTTTTTTTT");
+        check_stats(graph);
+    }
+}
@@ -0,0 +1,94 @@
+/*
+ *                             The MIT License
+ *
+ * Copyright (c) 2024 by Albert Jimenez-Blanco
+ *
+ * This file is part of #################### Theseus Library ####################.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+
+
+#include "../doctest.h"
+
+#include <string>
+
+#include "../../theseus/lcp.h"
+#include "../../include/theseus/packed_sequence.h"
+
+// Reference implementation: one character at a time
+static int naive_lcp_forward(const std::string &a, const std::string &b, int max_len) {
+    int k = 0;
+    while (k < max_len && a[k] == b[k]) ++k;
+    return k;
+}
+
+static int naive_lcp_backward(const std::string &a, const std::string &b, int max_len) {
+    int k = 0;
+    while (k < max_len && a[a.size() - 1 - k] == b[b.size() - 1 - k]) ++k;
+    return k;
+}
+
+TEST_CASE("LCP kernels") {
+    const std::string pattern = "ACGTTGCAACGGTACCATGACTTAGGCATCGATCGGATCCAGTCAAGTCCGATGCATTGACGTAGCTAGCTAGGATCCTAGGCAT";
+
+    SUBCASE("Forward kernel matches the scalar definition") {
+        for (int mismatch_pos = 0; mismatch_pos <= (int)pattern.size(); ++mismatch_pos) {
+            std::string text = pattern;
+            if (mismatch_pos < (int)text.size()) text[mismatch_pos] = 'N';
+            for (int max_len = 0; max_len <= (int)pattern.size(); ++max_len) {
+                CHECK(theseus::lcp_forward(pattern.data(), text.data(), max_len) ==
+                      naive_lcp_forward(pattern, text, max_len));
+            }
+        }
+    }
+
+    SUBCASE("Backward kernel matches the scalar definition") {
+        for (int mismatch_pos = 0; mismatch_pos <= (int)pattern.size(); ++mismatch_pos) {
+            std::string text = pattern;
+            if (mismatch_pos < (int)text.size()) text[text.size() - 1 - mismatch_pos] = 'N';
+            for (int max_len = 0; max_len <= (int)pattern.size(); ++max_len) {
+                CHECK(theseus::lcp_backward(pattern.data() + pattern.size(), text.data() + text.size(), max_len) ==
+                      naive_lcp_backward(pattern, text, max_len));
+            }
+        }
+    }
+
+    SUBCASE("Packed kernels match the scalar definition") {
+        const std::string long_pattern = pattern + pattern;
+        for (int mismatch_pos = 0; mismatch_pos <= (int)long_pattern.size(); mismatch_pos += 3) {
+            for (char c : {'A', 'N'}) {
+                // Mismatching base or exception at mismatch_pos, plus a shared exception
+                std::string a = long_pattern, b = long_pattern;
+                a[40] = b[40] = 'N';
+                if (mismatch_pos < (int)b.size() && b[mismatch_pos] != c) b[mismatch_pos] = c;
+                theseus::PackedSequence pa(a), pb(b);
+                for (int start = 0; start < 40; start += 7) {
+                    const int max_len = (int)a.size() - start;
+                    CHECK(theseus::lcp_packed_forward(pa, start, pb, start, max_len) ==
+                          naive_lcp_forward(a.substr(start), b.substr(start), max_len));
+                    CHECK(theseus::lcp_packed_backward(pa, a.size() - start, pb, b.size() - start, max_len) ==
+                          naive_lcp_backward(a.substr(0, a.size() - start), b.substr(0, b.size() - start), max_len));
+                }
+            }
+        }
+    }
+}
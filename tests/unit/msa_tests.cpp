@@ -31,11 +31,13 @@
 #include <vector>
 #include <string>
 #include <iostream>
+#include <random>
 #include "../../include/theseus/alignment.h"
 #include "../../include/theseus/penalties.h"
 #include "../../include/theseus/theseus_msa_aligner.h"
 #include "../../include/theseus/heuristics.h"
 #include "../../include/theseus/graph.h"
+#include "../random_sequences.h"
 
 using NodeId = theseus::Graph::NodeId;
 
@@ -57,7 +59,7 @@ TEST_CASE("Check MSA aligner") {
 
         // Check if alignment was successful
         CHECK(alignment.compute_affine_gap_score(penalties) == 0); // Check score
-        CHECK(alignment.edit_op == expected_cigar);                  // Check CIGAR
+        CHECK(alignment.edit_ops() == expected_cigar);                  // Check CIGAR
         CHECK(alignment.path == std::vector<NodeId>({0, 1, 2}));     // Check path
     }
 
@@ -77,7 +79,7 @@ TEST_CASE("Check MSA aligner") {
 
         // Check if alignment was successful
         CHECK(alignment.compute_affine_gap_score(penalties) == 2); // Check score
-        CHECK(alignment.edit_op == expected_cigar);                  // Check CIGAR
+        CHECK(alignment.edit_ops() == expected_cigar);                  // Check CIGAR
         CHECK(alignment.path == std::vector<NodeId>({0, 1, 2}));        // Check path
     }
 
@@ -97,7 +99,7 @@ TEST_CASE("Check MSA aligner") {
 
         // Check if alignment was successful
         CHECK(alignment.compute_affine_gap_score(penalties) == 6);    // Check score
-        CHECK(alignment.edit_op == expected_cigar);                      // Check CIGAR
+        CHECK(alignment.edit_ops() == expected_cigar);                      // Check CIGAR
         CHECK(alignment.path == std::vector<NodeId>({0, 1, 2}));         // Check path
     }
 
@@ -117,7 +119,7 @@ TEST_CASE("Check MSA aligner") {
 
         // Check if alignment was successful
         CHECK(alignment.compute_affine_gap_score(penalties) == 6); // Check score
-        CHECK(alignment.edit_op == expected_cigar);                  // Check CIGAR
+        CHECK(alignment.edit_ops() == expected_cigar);                  // Check CIGAR
         CHECK(alignment.path == std::vector<NodeId>({0, 1, 2}));        // Check path
     }
 
@@ -137,7 +139,7 @@ TEST_CASE("Check MSA aligner") {
 
         // Check if alignment was successful
         CHECK(alignment.compute_affine_gap_score(penalties) == 6); // Check score
-        CHECK(alignment.edit_op == expected_cigar);                  // Check CIGAR
+        CHECK(alignment.edit_ops() == expected_cigar);                  // Check CIGAR
         CHECK(alignment.path == std::vector<NodeId>({0, 1, 2}));        // Check path
     }
 
@@ -263,4 +265,25 @@ TEST_CASE("Check MSA aligner") {
         theseus::Alignment a_after_b_add = aligner.align_only(seq_a);
         CHECK(a_after_b_add.compute_affine_gap_score(penalties) == 0);
     }
+
+    SUBCASE("Bidirectional MSA alignment matches the full alignment") {
+        std::mt19937 rng(11);
+        std::string initial_seq = theseus_tests::random_sequence(rng, 2000);
+        std::string new_seq = theseus_tests::mutate(initial_seq, rng, 4, 2, 2);
+
+        theseus::Penalties penalties(0, 2, 3, 1);
+        theseus::Heuristics heuristics;
+        theseus::TheseusMSA aligner(penalties, heuristics, initial_seq, 1);
+        theseus::TheseusMSA bidirectional_aligner(penalties, heuristics, initial_seq, 1);
+
+        theseus::Alignment alignment = aligner.align(new_seq);
+        theseus::Alignment bidirectional = bidirectional_aligner.align_bidirectional(new_seq);
+        CHECK(bidirectional.theseus_status == THESEUS_STATUS_ALG_COMPLETED);
+        CHECK(bidirectional.compute_affine_gap_score(penalties) ==
+              alignment.compute_affine_gap_score(penalties));
+
+        // The sequence was added to the graph, so it now aligns perfectly
+        theseus::Alignment probe = bidirectional_aligner.align_only(new_seq);
+        CHECK(probe.compute_affine_gap_score(penalties) == 0);
+    }
 }
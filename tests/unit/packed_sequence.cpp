@@ -0,0 +1,153 @@
+/*
+ *                             The MIT License
+ *
+ * Copyright (c) 2024 by Albert Jimenez-Blanco
+ *
+ * This file is part of #################### Theseus Library ####################.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+
+
+#include "../doctest.h"
+
+#include <string>
+#include <vector>
+
+#include "../../include/theseus/packed_sequence.h"
+#include "../../include/theseus/graph.h"
+
+TEST_CASE("Packed sequences") {
+    const std::string dna = "ACGTTGCAACGGTACCATGACTTAGGCATCGATCGGATCCAGTCAAGTCCGATGCATTGACGTAGCTAGC";
+
+    SUBCASE("Round trip of plain DNA") {
+        theseus::PackedSequence packed(dna);
+        CHECK(packed.size() == dna.size());
+        CHECK(!packed.has_exceptions());
+        CHECK(packed.unpack() == dna);
+        for (size_t i = 0; i < dna.size(); ++i) {
+            CHECK(packed[i] == dna[i]);
+        }
+        CHECK(packed.memory_bytes() < dna.size());
+    }
+
+    SUBCASE("Exceptions are kept verbatim") {
+        std::string seq = dna;
+        seq[0] = 'N';
+        seq[33] = 'a';
+        seq[64] = 'R';
+        theseus::PackedSequence packed(seq);
+        CHECK(packed.has_exceptions());
+        CHECK(packed.unpack() == seq);
+        CHECK(packed.unpack(30) == seq.substr(30));
+        CHECK(packed.exceptions(0) == 1u);
+        CHECK((packed.exceptions(33) & 1u) == 1u);
+        CHECK(packed.reverse_complement_at(seq.size() - 1) == 'N');
+        CHECK(packed.reverse_complement_at(seq.size() - 1 - 64) == 'Y');
+        CHECK(packed.reverse_complement_at(seq.size() - 1 - 33) == 't');
+    }
+
+    SUBCASE("Append and truncate") {
+        theseus::PackedSequence packed;
+        packed.append(dna.substr(0, 40));
+        packed.append("NN");
+        packed.append(dna.substr(40));
+        CHECK(packed.unpack() == dna.substr(0, 40) + "NN" + dna.substr(40));
+
+        packed.truncate(40);
+        CHECK(packed.unpack() == dna.substr(0, 40));
+        CHECK(!packed.has_exceptions());
+
+        packed.append(dna.substr(40));
+        CHECK(packed.unpack() == dna);
+        CHECK(packed.bases(32) == theseus::PackedSequence(dna.substr(32)).bases(0));
+    }
+
+    SUBCASE("Packed graph nodes") {
+        theseus::Graph G;
+        auto n1 = G.add_node("ACGTN");
+        G.pack_sequences();
+        auto n2 = G.add_node("TTGCA");
+        G.add_edge(n1, n2);
+        CHECK(G.is_packed());
+
+        G.expand_sequence(n1, "GG");
+        CHECK(std::string(G.node(n1).sequence.begin(), G.node(n1).sequence.end()) == "ACGTNGG");
+        CHECK(std::string(G.node_rev(n2).sequence.begin(), G.node_rev(n2).sequence.end()) == "ACGTT");
+
+        CHECK(G.split_sequence(n1, 3) == "TNGG");
+        CHECK(G.node_size(n1) == 3);
+        CHECK(G.node(n1).sequence[2] == 'G');
+    }
+
+    SUBCASE("Packed nodes share one sequence") {
+        theseus::Graph G;
+        std::vector<std::string> seqs;
+        std::vector<theseus::Graph::NodeId> ids;
+        for (int i = 0; i < 20; ++i) {
+            seqs.push_back(dna.substr(i, 10 + i));
+            ids.push_back(G.add_node(seqs.back()));
+        }
+        G.pack_sequences();
+        auto sequence = [&](theseus::Graph::NodeId id) {
+            auto view = G.node(id).sequence;
+            return std::string(view.begin(), view.end());
+        };
+
+        // Growing a node in the middle moves it to the end
+        G.expand_sequence(ids[3], "NACGT");
+        seqs[3] += "NACGT";
+        G.split_sequence(ids[7], 4);
+        seqs[7].resize(4);
+        // Removing most of the nodes compacts the sequences
+        for (int i = 10; i < 20; ++i) {
+            G.remove_node(ids[i]);
+        }
+        ids.push_back(G.add_node("GATTACA"));
+        seqs.push_back("GATTACA");
+        size_t total_length = 7;
+        for (int i = 0; i < 10; ++i) {
+            CHECK(sequence(ids[i]) == seqs[i]);
+            total_length += seqs[i].size();
+        }
+        CHECK(sequence(ids.back()) == "GATTACA");
+        CHECK(std::string(G.node_rev(ids[3]).sequence.begin(), G.node_rev(ids[3]).sequence.end()) ==
+              std::string(seqs[3].rbegin(), seqs[3].rend()));
+        CHECK(G.total_sequence_length() == total_length);
+    }
+
+    SUBCASE("Packing reduces the memory of the graph") {
+        // Short pangenome-like nodes
+        theseus::Graph G;
+        theseus::Graph::NodeId prev = G.add_node(dna.substr(0, 24));
+        for (int i = 1; i < 2000; ++i) {
+            theseus::Graph::NodeId curr = G.add_node(dna.substr(i % 40, 24));
+            G.add_edge(prev, curr);
+            prev = curr;
+        }
+        const size_t unpacked_bytes = G.memory_bytes();
+        G.pack_sequences();
+        const size_t packed_bytes = G.memory_bytes();
+        CHECK(packed_bytes < unpacked_bytes);
+        // The 2-bit sequences take less than a byte for every 3 bases
+        CHECK(unpacked_bytes - packed_bytes > 2000 * 16);
+    }
+}
@@ -0,0 +1,72 @@
+/*
+ *                             The MIT License
+ *
+ * Copyright (c) 2024 by Albert Jimenez-Blanco
+ *
+ * This file is part of #################### Theseus Library ####################.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+
+#include "../doctest.h"
+
+#include <vector>
+
+#include "../../theseus/scratchpad.h"
+
+static theseus::Cell make_cell(theseus::Cell::idx2d_t diag, theseus::Cell::idx2d_t offset) {
+    return theseus::Cell{0, 0, offset, diag, theseus::Cell::Matrix::M};
+}
+
+TEST_CASE("Scratchpad window") {
+    theseus::ScratchPad scratchpad(4);
+
+    // Far away diagonals move the empty window
+    scratchpad.merge_max(make_cell(-1000000, 3));
+    CHECK(scratchpad.capacity() == 4);
+    CHECK(scratchpad[-1000000].offset == 3);
+    scratchpad.reset();
+    scratchpad.merge_max(make_cell(500000, 1));
+    CHECK(scratchpad.capacity() == 4);
+    scratchpad.reset();
+
+    // The window grows to keep all the active diagonals
+    std::vector<theseus::Cell::idx2d_t> diags = {10, 11, 7, 30, -5, 11, 30};
+    std::vector<theseus::Cell::idx2d_t> offsets = {1, 2, 3, 4, 5, 0, 9};
+    for (size_t l = 0; l < diags.size(); ++l) {
+        scratchpad.merge_max(make_cell(diags[l], offsets[l]));
+    }
+    CHECK(scratchpad.capacity() >= 36);
+    CHECK(scratchpad.nactive_diags() == 5);
+    const std::vector<theseus::Cell::idx2d_t> expected_diags = {10, 11, 7, 30, -5};
+    const auto active = scratchpad.active_diags();
+    CHECK(std::vector<theseus::Cell::idx2d_t>(active.begin(), active.end()) == expected_diags);
+    CHECK(scratchpad[10].offset == 1);
+    CHECK(scratchpad[11].offset == 2);
+    CHECK(scratchpad[7].offset == 3);
+    CHECK(scratchpad[30].offset == 9);
+    CHECK(scratchpad[-5].offset == 5);
+
+    scratchpad.reset();
+    CHECK(scratchpad.nactive_diags() == 0);
+    scratchpad.merge_max(make_cell(7, 0));
+    CHECK(scratchpad.nactive_diags() == 1);
+}
@@ -33,13 +33,18 @@
 #include <string>
 #include <sstream>
 #include <fstream>
+#include <random>
+#include <stdexcept>
 #include "../../include/theseus/graph.h"
 #include "../../include/theseus/alignment.h"
 #include "../../include/theseus/penalties.h"
 #include "../../include/theseus/theseus_aligner.h"
+#include "../random_sequences.h"
 
 
 using NodeId = theseus::Graph::NodeId;
+using theseus_tests::random_sequence;
+using theseus_tests::mutate;
 
 TEST_CASE("Check sequence-to-graph aligner") {
     SUBCASE("Correct alignment of sequences against a graph with a cycle") {
@@ -103,8 +108,438 @@ TEST_CASE("Check sequence-to-graph aligner") {
             );
 
             CHECK(alignment.compute_affine_gap_score(penalties) == expected_scores[i]); // Check score
-            CHECK(alignment.edit_op == expected_cigars[i]);        // Check CIGAR
+            CHECK(alignment.edit_ops() == expected_cigars[i]);        // Check CIGAR
             CHECK(alignment.path == expected_paths[i]); // Check path
+
+            // Score-only alignment
+            theseus::AlignmentScore score = aligner.align_score(
+                sequences[i], start_vertices[i], start_offsets[i], false, false
+            );
+            CHECK(score.theseus_status == THESEUS_STATUS_ALG_COMPLETED);
+            CHECK(score.score == expected_scores[i]);
+            CHECK(score.end_node == expected_paths[i].back());
+            CHECK(score.end_offset == alignment.end_offset);
         }
     }
-}
\ No newline at end of file
+
+    SUBCASE("Packed graph sequences give the same alignments") {
+        theseus::Graph G;
+        NodeId n1 = G.add_node("ACTTAGGATCCAGTCAAGTCCGATGCATTGACGTAGCTAGCTAGGATCC");
+        NodeId n2 = G.add_node("ACANTT");
+        NodeId n3 = G.add_node("GTACTTGCAACGGTACCATGACTTAGGCATCGATCGGATCCAGTCAAGT");
+        G.add_edge(n1, n2);
+        G.add_edge(n2, n3);
+        theseus::Graph packed_G = G;
+        packed_G.pack_sequences();
+
+        std::vector<std::string> sequences = {
+            "GATGCATTGACGTAGCTAGCTAGGATCCACANTTGTACTTGCAACGGTACCATGACTTAGG",
+            "GATGCATTGACGTAGCTAGCTAGGATCCACAGTTGTACTTGCAACGGTACCATGACTTAGG",
+            "GATGCATTGACGTAGCTACTAGGATCCACANTTGTACTTGCAACGTTACCATGACTTAGG"
+        };
+
+        theseus::Penalties penalties(0, 2, 3, 1);
+        theseus::Heuristics heuristics;
+        theseus::TheseusAligner aligner(penalties, heuristics, std::move(G));
+        theseus::TheseusAligner packed_aligner(penalties, heuristics, std::move(packed_G));
+
+        for (const auto &seq : sequences) {
+            NodeId start_node = n1;
+            theseus::Alignment alignment = aligner.align(seq, start_node, 25, false, false);
+            start_node = n1;
+            theseus::Alignment packed_alignment = packed_aligner.align(seq, start_node, 25, false, false);
+
+            CHECK(packed_alignment.cigar == alignment.cigar);
+            CHECK(packed_alignment.path == alignment.path);
+        }
+    }
+
+    SUBCASE("Bidirectional alignment matches the full alignment") {
+        std::mt19937 rng(7);
+        std::string reference = random_sequence(rng, 3000);
+        // Mutate roughly 8% of the positions so the score exceeds the base case
+        std::string seq = mutate(reference, rng, 4, 2, 2);
+
+        theseus::Graph G;
+        NodeId n1 = G.add_node(reference.substr(0, 1000));
+        NodeId n2 = G.add_node(reference.substr(1000, 1000));
+        NodeId n3 = G.add_node("ACGT");
+        NodeId n4 = G.add_node(reference.substr(2000));
+        G.add_edge(n1, n2);
+        G.add_edge(n2, n3);
+        G.add_edge(n2, n4);
+        G.add_edge(n3, n4);
+
+        theseus::Penalties penalties(0, 2, 3, 1);
+        theseus::Heuristics heuristics;
+        theseus::TheseusAligner aligner(penalties, heuristics, std::move(G));
+
+        NodeId start_node = n1;
+        theseus::Alignment alignment = aligner.align(seq, start_node, 0, false, false);
+        theseus::Alignment bidirectional = aligner.align_bidirectional(seq, n1, 0);
+
+        CHECK(bidirectional.theseus_status == THESEUS_STATUS_ALG_COMPLETED);
+        CHECK(bidirectional.compute_affine_gap_score(penalties) ==
+              alignment.compute_affine_gap_score(penalties));
+        CHECK(bidirectional.end_offset == alignment.end_offset);
+        CHECK(bidirectional.path.back() == alignment.path.back());
+    }
+
+    SUBCASE("Checkpointed alignment matches the full alignment") {
+        std::mt19937 rng(13);
+        std::string reference = random_sequence(rng, 2000);
+        std::string seq = mutate(reference, rng, 3, 2, 2);
+
+        theseus::Graph G;
+        NodeId n1 = G.add_node(reference.substr(0, 700));
+        NodeId n2 = G.add_node(reference.substr(700, 600));
+        NodeId n3 = G.add_node("GATTACA");
+        NodeId n4 = G.add_node(reference.substr(1300));
+        G.add_edge(n1, n2);
+        G.add_edge(n1, n3);
+        G.add_edge(n2, n4);
+        G.add_edge(n3, n4);
+
+        theseus::Penalties penalties(0, 2, 3, 1);
+        theseus::Heuristics heuristics;
+        theseus::TheseusAligner aligner(penalties, heuristics, std::move(G));
+
+        NodeId start_node = n1;
+        theseus::Alignment alignment = aligner.align(seq, start_node, 0);
+        for (int interval : {1, 10, 50, 1000}) {
+            aligner.set_checkpoint_interval(interval);
+            start_node = n1;
+            theseus::Alignment checkpointed = aligner.align(seq, start_node, 0);
+            CHECK(checkpointed.theseus_status == THESEUS_STATUS_ALG_COMPLETED);
+            CHECK(checkpointed.compute_affine_gap_score(penalties) ==
+                  alignment.compute_affine_gap_score(penalties));
+            CHECK(checkpointed.end_offset == alignment.end_offset);
+            CHECK(checkpointed.path == alignment.path);
+        }
+    }
+
+    SUBCASE("Budgets stop the alignment") {
+        std::mt19937 rng(17);
+        std::string reference = random_sequence(rng, 1000);
+        // Unrelated sequence: its score is high
+        std::string seq = random_sequence(rng, 1000);
+
+        theseus::Graph G;
+        NodeId n1 = G.add_node(reference);
+
+        theseus::Penalties penalties(0, 2, 3, 1);
+        theseus::Heuristics heuristics;
+        theseus::TheseusAligner aligner(penalties, heuristics, std::move(G));
+
+        NodeId start_node = n1;
+        theseus::Alignment alignment = aligner.align(seq, start_node, 0);
+        CHECK(alignment.theseus_status == THESEUS_STATUS_ALG_COMPLETED);
+        const int score = alignment.compute_affine_gap_score(penalties);
+
+        // Maximum score
+        theseus::Heuristics max_score_heuristics;
+        max_score_heuristics.set_max_score(score / 2);
+        aligner.set_heuristics(max_score_heuristics);
+        start_node = n1;
+        alignment = aligner.align(seq, start_node, 0);
+        CHECK(alignment.theseus_status == THESEUS_STATUS_MAX_STEPS_REACHED);
+        CHECK(alignment.cigar.empty());
+        CHECK(aligner.align_score(seq, n1, 0).theseus_status == THESEUS_STATUS_MAX_STEPS_REACHED);
+
+        // Maximum score relative to the length of the sequence
+        theseus::Heuristics per_base_heuristics;
+        per_base_heuristics.set_max_score_per_base(0.1);
+        aligner.set_heuristics(per_base_heuristics);
+        start_node = n1;
+        alignment = aligner.align(seq, start_node, 0);
+        CHECK(alignment.theseus_status == THESEUS_STATUS_MAX_STEPS_REACHED);
+
+        // Maximum number of cells, with a partial alignment
+        theseus::Heuristics max_cells_heuristics;
+        max_cells_heuristics.set_max_cells(10000);
+        max_cells_heuristics.set_partial_alignment_on_limit(true);
+        aligner.set_heuristics(max_cells_heuristics);
+        start_node = n1;
+        alignment = aligner.align(seq, start_node, 0);
+        CHECK(alignment.theseus_status == THESEUS_STATUS_MAX_STEPS_REACHED);
+        CHECK(!alignment.cigar.empty());
+        CHECK(alignment.path.front() == n1);
+
+        // A budget above the score does not change the alignment
+        theseus::Heuristics loose_heuristics;
+        loose_heuristics.set_max_score(score);
+        aligner.set_heuristics(loose_heuristics);
+        start_node = n1;
+        alignment = aligner.align(seq, start_node, 0);
+        CHECK(alignment.theseus_status == THESEUS_STATUS_ALG_COMPLETED);
+        CHECK(alignment.compute_affine_gap_score(penalties) == score);
+    }
+
+    SUBCASE("Run-length CIGAR") {
+        theseus::Graph G;
+        NodeId n1 = G.add_node("ACGTACGTTTGA");
+        NodeId n2 = G.add_node("CCATGAC");
+        G.add_edge(n1, n2);
+
+        theseus::Penalties penalties(0, 2, 3, 1);
+        theseus::Heuristics heuristics;
+        theseus::TheseusAligner aligner(penalties, heuristics, std::move(G));
+
+        NodeId start_node = n1;
+        theseus::Alignment alignment = aligner.align("ACGTACGTTTGACCATGAC", start_node, 0);
+        CHECK(alignment.cigar == std::vector<theseus::CigarRun>{{'M', 19}});
+        alignment = aligner.align("ACGTACTTTTGACCATGAC", start_node, 0);
+        CHECK(alignment.cigar_string() == "6M1X12M");
+        CHECK(alignment.compute_affine_gap_score(penalties) == 2);
+        alignment = aligner.align("ACGTACGTTTGATTTCCATGAC", start_node, 0);
+        CHECK(alignment.cigar_string() == "12M3D7M");
+        CHECK(alignment.edit_ops().size() == 22);
+        CHECK(alignment.compute_affine_gap_score(penalties) == 6);
+    }
+
+    SUBCASE("Ends-free alignment") {
+        theseus::Graph G;
+        NodeId n1 = G.add_node("ACGTACGTTTGA");
+        NodeId n2 = G.add_node("CCATGAC");
+        G.add_edge(n1, n2);
+
+        theseus::Penalties penalties(0, 2, 3, 1);
+        theseus::Heuristics heuristics;
+        theseus::TheseusAligner aligner(penalties, heuristics, std::move(G));
+
+        // The read hangs off the end of the graph
+        const std::string tail_seq = "ACGTACGTTTGACCATGACTTTTTTTTTT";
+        NodeId start_node = n1;
+        theseus::Alignment alignment = aligner.align(tail_seq, start_node, 0);
+        CHECK(alignment.compute_affine_gap_score(penalties) == 13);
+        CHECK(alignment.query_end == 29);
+
+        theseus::EndsFree free_query;
+        free_query.query_suffix = true;
+        alignment = aligner.align(tail_seq, start_node, 0, false, false, free_query);
+        CHECK(alignment.theseus_status == THESEUS_STATUS_ALG_COMPLETED);
+        CHECK(alignment.compute_affine_gap_score(penalties) == 0);
+        CHECK(alignment.query_end == 19);
+        CHECK(alignment.edit_ops() == std::vector<char>(19, 'M'));
+        CHECK(alignment.path == std::vector<NodeId>{n1, n2});
+        CHECK(alignment.end_offset == 7);
+        theseus::AlignmentScore score = aligner.align_score(tail_seq, n1, 0, false, false, free_query);
+        CHECK(score.score == 0);
+        CHECK(score.query_end == 19);
+        aligner.set_checkpoint_interval(1);
+        alignment = aligner.align(tail_seq, start_node, 0, false, false, free_query);
+        CHECK(alignment.compute_affine_gap_score(penalties) == 0);
+        CHECK(alignment.query_end == 19);
+        aligner.set_checkpoint_interval(0);
+
+        // The alignment has to reach the end of the graph
+        const std::string short_seq = "ACGTACGTTTGACC";
+        alignment = aligner.align(short_seq, start_node, 0);
+        CHECK(alignment.compute_affine_gap_score(penalties) == 0);
+        CHECK(alignment.end_offset == 2);
+        theseus::EndsFree sink_end;
+        sink_end.graph_suffix = false;
+        alignment = aligner.align(short_seq, start_node, 0, false, false, sink_end);
+        CHECK(alignment.theseus_status == THESEUS_STATUS_ALG_COMPLETED);
+        CHECK(alignment.compute_affine_gap_score(penalties) == 8);
+        CHECK(alignment.path.back() == n2);
+        CHECK(alignment.end_offset == 7);
+        CHECK(alignment.query_end == 14);
+    }
+
+    SUBCASE("Adaptive reduction") {
+        std::mt19937 rng(29);
+        theseus_tests::BubbleChain chain = theseus_tests::bubble_chain(rng, 40, 20, 20, 30);
+        theseus::Graph &G = chain.graph;
+        // Divergent sequence
+        std::string seq = mutate(chain.reference, rng, 5, 5, 5);
+
+        theseus::Penalties penalties(0, 2, 3, 1);
+        theseus::Heuristics heuristics;
+        theseus::Graph G_copy = G;
+        theseus::TheseusAligner aligner(penalties, heuristics, std::move(G));
+        NodeId start_node = 0;
+        theseus::Alignment alignment = aligner.align(seq, start_node, 0);
+        const int score = alignment.compute_affine_gap_score(penalties);
+
+        theseus::Heuristics adaptive_heuristics;
+        adaptive_heuristics.set_adaptive_reduction(50, 10);
+        theseus::TheseusAligner adaptive_aligner(penalties, adaptive_heuristics, std::move(G_copy));
+        theseus::Alignment adaptive_alignment = adaptive_aligner.align(seq, start_node, 0);
+        CHECK(adaptive_alignment.theseus_status == THESEUS_STATUS_ALG_COMPLETED);
+        const int adaptive_score = adaptive_alignment.compute_affine_gap_score(penalties);
+        CHECK(adaptive_score >= score);
+        CHECK(adaptive_score <= score + score / 20);
+    }
+
+    SUBCASE("X-drop extension") {
+        std::mt19937 rng(23);
+        std::string reference = random_sequence(rng, 600);
+        // The first 300 bases come from the graph, the rest are unrelated
+        std::string seq = reference.substr(0, 300);
+        seq[100] = (seq[100] == 'A') ? 'C' : 'A';
+        seq += random_sequence(rng, 300);
+
+        theseus::Graph G;
+        NodeId n1 = G.add_node(reference.substr(0, 200));
+        NodeId n2 = G.add_node(reference.substr(200));
+        G.add_edge(n1, n2);
+
+        theseus::Penalties penalties(0, 2, 3, 1);
+        theseus::Heuristics heuristics;
+        heuristics.set_xdrop(20);
+        theseus::TheseusAligner aligner(penalties, heuristics, std::move(G));
+
+        NodeId start_node = n1;
+        theseus::Alignment alignment = aligner.align(seq, start_node, 0);
+        CHECK(alignment.theseus_status == THESEUS_STATUS_ALG_PARTIAL);
+        CHECK(alignment.query_end >= 300);
+        CHECK(alignment.query_end < 320);
+        CHECK(alignment.path == std::vector<NodeId>{n1, n2});
+        const int score = alignment.compute_affine_gap_score(penalties);
+        CHECK(score >= 2);
+        CHECK(score < 20);
+
+        theseus::AlignmentScore extension = aligner.align_score(seq, n1, 0);
+        CHECK(extension.theseus_status == THESEUS_STATUS_ALG_PARTIAL);
+        CHECK(extension.score == score);
+        CHECK(extension.query_end == alignment.query_end);
+        aligner.set_checkpoint_interval(10);
+        theseus::Alignment checkpointed = aligner.align(seq, start_node, 0);
+        CHECK(checkpointed.theseus_status == THESEUS_STATUS_ALG_PARTIAL);
+        CHECK(checkpointed.cigar == alignment.cigar);
+        aligner.set_checkpoint_interval(0);
+
+        // A similar sequence is aligned to its end
+        std::string similar = reference.substr(0, 500);
+        similar[250] = (similar[250] == 'A') ? 'C' : 'A';
+        alignment = aligner.align(similar, start_node, 0);
+        CHECK(alignment.theseus_status == THESEUS_STATUS_ALG_COMPLETED);
+        CHECK(alignment.compute_affine_gap_score(penalties) == 2);
+        CHECK(alignment.query_end == 500);
+    }
+
+    SUBCASE("Linear gap penalties") {
+        theseus::Graph G;
+        NodeId n1 = G.add_node("ACGTACGTTTGA");
+        NodeId n2 = G.add_node("CCATGAC");
+        G.add_edge(n1, n2);
+
+        theseus::Penalties penalties(0, 2, 1);
+        theseus::Heuristics heuristics;
+        theseus::TheseusAligner aligner(penalties, heuristics, std::move(G));
+
+        std::vector<std::string> sequences = {"ACGTACGTTTGACCATGAC", "ACGTACGTTTTGACCATGAC", "ACGTACGTTGACCATGAC",
+                                              "ACGTACTTTTGACCATGAC", "ACGTACGTTTGACCAGAATGAC",
+                                              "ACGTACGTTTCATGAC"};
+        std::vector<int> expected_scores = {0, 1, 1, 2, 3, 3};
+        for (size_t i = 0; i < sequences.size(); ++i) {
+            NodeId start_node = n1;
+            theseus::Alignment alignment = aligner.align(sequences[i], start_node, 0);
+            CHECK(alignment.theseus_status == THESEUS_STATUS_ALG_COMPLETED);
+            CHECK(alignment.compute_affine_gap_score(penalties) == expected_scores[i]);
+        }
+    }
+
+    SUBCASE("Dual affine-gap penalties are rejected by the aligner") {
+        theseus::Penalties dual_penalties(0, 4, 6, 2, 24, 1);
+        theseus::Heuristics heuristics;
+        CHECK_THROWS_AS(theseus::TheseusAligner(dual_penalties, heuristics, theseus::Graph()),
+                        std::invalid_argument);
+    }
+
+    SUBCASE("Parallel wave") {
+        std::mt19937 rng(37);
+        theseus_tests::BubbleChain chain = theseus_tests::bubble_chain(rng, 60, 3, 2, 4);
+        theseus::Graph &G = chain.graph;
+        std::string seq = mutate(chain.reference, rng, 6, 6, 6);
+
+        for (theseus::Penalties penalties : {theseus::Penalties(0, 2, 3, 1), theseus::Penalties(0, 2, 1)}) {
+            theseus::Heuristics heuristics;
+            theseus::TheseusAligner aligner(penalties, heuristics, G);
+            NodeId start_node = 0;
+            theseus::Alignment expected = aligner.align(seq, start_node, 0);
+            REQUIRE(expected.theseus_status == THESEUS_STATUS_ALG_COMPLETED);
+            const int score = expected.compute_affine_gap_score(penalties);
+
+            // Same score, and the same alignment for any number of threads
+            std::vector<theseus::Alignment> alignments;
+            for (int num_threads : {2, 3, 4}) {
+                aligner.set_parallel_wave(num_threads);
+                alignments.push_back(aligner.align(seq, start_node, 0));
+                CHECK(alignments.back().theseus_status == THESEUS_STATUS_ALG_COMPLETED);
+                CHECK(alignments.back().compute_affine_gap_score(penalties) == score);
+                CHECK(alignments.back().cigar == alignments.front().cigar);
+                CHECK(alignments.back().path == alignments.front().path);
+                CHECK(aligner.align_score(seq, start_node, 0).score == score);
+            }
+            aligner.set_parallel_wave(0);
+            const theseus::Alignment sequential = aligner.align(seq, start_node, 0);
+            CHECK(sequential.cigar == expected.cigar);
+            CHECK(sequential.path == expected.path);
+        }
+    }
+
+    SUBCASE("Batch alignment") {
+        std::mt19937 rng(31);
+        theseus_tests::BubbleChain chain = theseus_tests::bubble_chain(rng, 10, 8, 6, 12);
+        theseus::Graph &G = chain.graph;
+        const std::string &reference = chain.reference;
+        // Sequences of different lengths
+        std::vector<std::string> sequences;
+        for (int s = 0; s < 40; ++s) {
+            const size_t length = 20 + rng() % (reference.size() - 20);
+            sequences.push_back(mutate(reference.substr(0, length), rng, 10, 0, 0));
+        }
+        std::vector<std::string_view> views(sequences.begin(), sequences.end());
+        std::vector<NodeId> start_nodes(sequences.size(), 0);
+        std::vector<int> start_offsets(sequences.size(), 0);
+
+        theseus::Penalties penalties(0, 2, 3, 1);
+        theseus::Heuristics heuristics;
+        theseus::TheseusAligner aligner(penalties, heuristics, G);
+        std::vector<theseus::Alignment> expected;
+        for (size_t i = 0; i < sequences.size(); ++i) {
+            NodeId start_node = 0;
+            expected.push_back(aligner.align(sequences[i], start_node, 0));
+        }
+        for (int num_threads : {1, 4}) {
+            std::vector<theseus::Alignment> alignments = aligner.align_batch(views, start_nodes, start_offsets,
+                                                                            num_threads);
+            REQUIRE(alignments.size() == sequences.size());
+            for (size_t i = 0; i < sequences.size(); ++i) {
+                CHECK(alignments[i].theseus_status == expected[i].theseus_status);
+                CHECK(alignments[i].cigar == expected[i].cigar);
+                CHECK(alignments[i].path == expected[i].path);
+                CHECK(alignments[i].end_offset == expected[i].end_offset);
+                CHECK(alignments[i].query_length == static_cast<int>(sequences[i].size()));
+            }
+        }
+
+        // The heuristics of the aligner also apply to the other threads
+        theseus::Heuristics limited_heuristics;
+        limited_heuristics.set_max_score(1);
+        aligner.set_heuristics(limited_heuristics);
+        std::vector<theseus::Alignment> limited = aligner.align_batch(views, start_nodes, start_offsets, 4);
+        for (size_t i = 0; i < sequences.size(); ++i) {
+            NodeId start_node = 0;
+            CHECK(limited[i].theseus_status == aligner.align(sequences[i], start_node, 0).theseus_status);
+        }
+
+        // So does the parallel wave, and the threads are reused by the following batches
+        aligner.set_heuristics(heuristics);
+        aligner.set_parallel_wave(2);
+        for (int batch = 0; batch < 2; ++batch) {
+            std::vector<theseus::Alignment> parallel = aligner.align_batch(views, start_nodes, start_offsets, 4);
+            for (size_t i = 0; i < sequences.size(); ++i) {
+                NodeId start_node = 0;
+                theseus::Alignment alignment = aligner.align(sequences[i], start_node, 0);
+                CHECK(parallel[i].cigar == alignment.cigar);
+                CHECK(parallel[i].path == alignment.path);
+            }
+        }
+
+        CHECK_THROWS_AS(aligner.align_batch(views, std::span<const NodeId>(start_nodes).first(1), start_offsets),
+                        std::invalid_argument);
+    }
+}
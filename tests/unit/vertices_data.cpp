@@ -0,0 +1,143 @@
+/*
+ *                             The MIT License
+ *
+ * Copyright (c) 2024 by Albert Jimenez-Blanco
+ *
+ * This file is part of #################### Theseus Library ####################.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+
+
+#include "../doctest.h"
+
+#include <random>
+#include <vector>
+
+#include "../../theseus/vertices_data.h"
+
+// Reference implementation: grow every invalidated diagonal on its own, as
+// if the segments were never merged
+struct NaiveSegment {
+    int start_d, end_d;
+    int down_time, up_time;
+};
+
+static bool naive_valid(const std::vector<NaiveSegment> &segments, int nexpansions, int gape, int diag) {
+    for (const auto &s : segments) {
+        int start = s.start_d, end = s.end_d;
+        if (nexpansions >= s.down_time) start -= 1 + (nexpansions - s.down_time) / gape;
+        if (nexpansions >= s.up_time) end += 1 + (nexpansions - s.up_time) / gape;
+        if (start <= diag && diag <= end) return false;
+    }
+    return true;
+}
+
+static bool merged_valid(const theseus::VerticesData &vertices_data,
+                         const theseus::VerticesData::InvalidSet &invalid, int diag) {
+    for (const auto &inv : invalid.segments) {
+        const auto seg = vertices_data.bounds(inv);
+        if (seg.start_d <= diag && diag <= seg.end_d) return false;
+    }
+    return true;
+}
+
+TEST_CASE("Invalid diagonals") {
+    theseus::Penalties penalties(0, 2, 3, 1);
+    theseus::VerticesData vertices_data(penalties, 8, 4);
+    vertices_data.activate_vertex(3);
+    const int idx = vertices_data.get_id(3);
+
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> diag_dist(-200, 200);
+    std::vector<theseus::Cell::idx2d_t> diags(101);
+    for (int l = 0; l < (int)diags.size(); ++l) diags[l] = l - 50;
+    std::vector<uint8_t> valid(diags.size());
+    std::vector<NaiveSegment> naive_m;  // Invalidated diagonals of the M matrix
+
+    const int gapo = penalties.gapo(), gape = penalties.gape();
+    for (int score = 1; score <= 60; ++score) {
+        vertices_data.expand();
+        // Jumps invalidate diagonals during the score
+        for (int k = 0; k < 3; ++k) {
+            const int diag = diag_dist(gen) / 4;
+            if (gen() % 2) {
+                vertices_data.invalidate_m_jump(idx, diag);
+                naive_m.push_back({diag, diag, score + gapo + gape, score + gapo + gape});
+            }
+            else {
+                vertices_data.invalidate_i_jump(idx, diag);
+                naive_m.push_back({diag, diag, score + gapo + gape, score + gape});
+            }
+
+            vertices_data.valid_diagonals<theseus::Cell::Matrix::M>(3, diags, valid.data());
+            for (size_t l = 0; l < diags.size(); ++l) {
+                CHECK(valid[l] == vertices_data.valid_diagonal<theseus::Cell::Matrix::M>(3, diags[l]));
+                CHECK(valid[l] == naive_valid(naive_m, score, gape, diags[l]));
+                CHECK(valid[l] == merged_valid(vertices_data, vertices_data.get_vertex_data(3)._m_invalid, diags[l]));
+            }
+            vertices_data.valid_diagonals<theseus::Cell::Matrix::D>(3, diags, valid.data());
+            for (size_t l = 0; l < diags.size(); ++l) {
+                CHECK(valid[l] == vertices_data.valid_diagonal<theseus::Cell::Matrix::D>(3, diags[l]));
+            }
+        }
+    }
+
+    SUBCASE("Sparse diagonals") {
+        const std::vector<theseus::Cell::idx2d_t> sparse = {-1000, 0, 7, 1000};
+        vertices_data.valid_diagonals<theseus::Cell::Matrix::I>(3, sparse, valid.data());
+        for (size_t l = 0; l < sparse.size(); ++l) {
+            CHECK(valid[l] == vertices_data.valid_diagonal<theseus::Cell::Matrix::I>(3, sparse[l]));
+        }
+    }
+}
+
+TEST_CASE("Live vertices") {
+    theseus::Penalties penalties(0, 2, 3, 1);
+    const int nscores = 5;
+    theseus::VerticesData vertices_data(penalties, nscores, 4);
+    vertices_data.activate_vertex(0);
+    vertices_data.activate_vertex(1);
+    vertices_data.activate_vertex(2);
+    vertices_data.add_m_jump(2, 0, 7);
+    vertices_data.add_i_jump(0, 0, 3);
+    // Activated vertices without jumps are not processed
+    CHECK(vertices_data.live_vertices() == std::vector<int>{0, 2});
+
+    // Vertices without data in the scope are retired
+    vertices_data.mark_live(vertices_data.get_id(2), 2);
+    for (int score = 1; score <= nscores + 1; ++score) {
+        vertices_data.new_score(score);
+    }
+    CHECK(vertices_data.live_vertices() == std::vector<int>{2});
+    vertices_data.new_score(nscores + 2);
+    CHECK(vertices_data.live_vertices().empty());
+
+    // A new jump revives them, without the jumps stored before retiring
+    const int score = nscores + 3;
+    vertices_data.new_score(score);
+    vertices_data.add_m_jump(1, score, 11);
+    vertices_data.add_m_jump(0, score, 12);
+    CHECK(vertices_data.live_vertices() == std::vector<int>{0, 1});
+    CHECK(vertices_data.get_vertex_data(0)._i_jumps_positions[vertices_data.get_pos(0)].empty());
+    CHECK(vertices_data.get_vertex_data(0)._m_jumps_positions[vertices_data.get_pos(score)] ==
+          std::vector<theseus::VerticesData::pos_t>{12});
+}
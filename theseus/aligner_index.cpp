@@ -0,0 +1,48 @@
+/*
+ *                             The MIT License
+ *
+ * Copyright (c) 2024 by Albert Jimenez-Blanco
+ *
+ * This file is part of #################### Theseus Library ####################.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+
+#include "theseus/aligner_index.h"
+
+#include "penalty_model.h"
+
+namespace theseus {
+
+AlignerIndex::AlignerIndex(const Penalties &penalties,
+                           const Graph &graph) : AlignerIndex(penalties, Graph(graph)) {}
+
+AlignerIndex::AlignerIndex(const Penalties &penalties,
+                           Graph &&graph) : graph_(std::make_shared<const Graph>(std::move(graph))),
+                                            penalties_(std::make_shared<const PenaltyModels>(penalties)) {}
+
+AlignerIndex::~AlignerIndex() {}
+
+const Penalties &AlignerIndex::penalties() const {
+    return penalties_->penalties;
+}
+
+} // namespace theseus
@@ -0,0 +1,139 @@
+/*
+ *                             The MIT License
+ *
+ * Copyright (c) 2024 by Albert Jimenez-Blanco
+ *
+ * This file is part of #################### Theseus Library ####################.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+
+#include "theseus/aligner_workspace.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <tuple>
+
+#include "theseus_aligner_impl.h"
+
+namespace theseus {
+
+AlignerWorkspace::AlignerWorkspace(std::shared_ptr<const AlignerIndex> index,
+                                   const Heuristics &heuristics) : index_(std::move(index))
+{
+    aligner_impl_ = std::make_unique<TheseusAlignerImpl>(index_->penalties_, heuristics, index_->graph_);
+}
+
+AlignerWorkspace::AlignerWorkspace(AlignerWorkspace &&) noexcept = default;
+AlignerWorkspace &AlignerWorkspace::operator=(AlignerWorkspace &&) noexcept = default;
+
+AlignerWorkspace::~AlignerWorkspace() {}
+
+Alignment AlignerWorkspace::align(
+    std::string_view seq,
+    NodeId start_node,
+    int start_offset,
+    bool density_drop_active,
+    bool lag_pruning_active,
+    EndsFree ends_free) {
+
+    return aligner_impl_->align(seq, start_node, start_offset, 1, ends_free, false, density_drop_active, lag_pruning_active);
+}
+
+void AlignerWorkspace::align_into(
+    Alignment &alignment,
+    std::string_view seq,
+    NodeId start_node,
+    int start_offset,
+    bool density_drop_active,
+    bool lag_pruning_active,
+    EndsFree ends_free) {
+
+    aligner_impl_->align_into(alignment, seq, start_node, start_offset, 1, ends_free, false, density_drop_active, lag_pruning_active);
+}
+
+void AlignerWorkspace::align_batch_into(
+    std::span<Alignment> alignments,
+    std::span<const std::string_view> seqs,
+    std::span<const NodeId> start_nodes,
+    std::span<const int> start_offsets,
+    bool density_drop_active,
+    bool lag_pruning_active,
+    EndsFree ends_free) {
+
+    if (alignments.size() != seqs.size() || start_nodes.size() != seqs.size() ||
+        start_offsets.size() != seqs.size()) {
+        throw std::invalid_argument("[Theseus] align_batch_into: one alignment and start position per sequence is required");
+    }
+    // Sort the sequences by start position, and the equal ones together
+    auto key = [&](size_t i) { return std::tie(start_nodes[i], start_offsets[i], seqs[i]); };
+    batch_order_.resize(seqs.size());
+    for (size_t i = 0; i < seqs.size(); ++i) {
+        batch_order_[i] = i;
+    }
+    std::sort(batch_order_.begin(), batch_order_.end(), [&](size_t a, size_t b) { return key(a) < key(b); });
+
+    for (size_t l = 0; l < batch_order_.size(); ++l) {
+        const size_t i = batch_order_[l];
+        if (l > 0 && key(batch_order_[l - 1]) == key(i)) {
+            alignments[i] = alignments[batch_order_[l - 1]];   // Same problem as the previous one
+            continue;
+        }
+        aligner_impl_->align_into(alignments[i], seqs[i], start_nodes[i], start_offsets[i], 1, ends_free, false,
+                                  density_drop_active, lag_pruning_active);
+    }
+}
+
+AlignmentScore AlignerWorkspace::align_score(
+    std::string_view seq,
+    NodeId start_node,
+    int start_offset,
+    bool density_drop_active,
+    bool lag_pruning_active,
+    EndsFree ends_free) {
+
+    return aligner_impl_->align_score(seq, start_node, start_offset, false, density_drop_active, lag_pruning_active,
+                                      ends_free);
+}
+
+Alignment AlignerWorkspace::align_bidirectional(
+    std::string_view seq,
+    NodeId start_node,
+    int start_offset) {
+
+    Alignment alignment;
+    aligner_impl_->align_bidirectional_into(alignment, seq, start_node, start_offset, 1, false);
+    return alignment;
+}
+
+void AlignerWorkspace::set_heuristics(const Heuristics &heuristics) {
+    aligner_impl_->set_heuristics(heuristics);
+}
+
+void AlignerWorkspace::set_checkpoint_interval(int interval) {
+    aligner_impl_->set_checkpoint_interval(interval);
+}
+
+void AlignerWorkspace::set_parallel_wave(int num_threads) {
+    aligner_impl_->set_parallel_wave(num_threads);
+}
+
+} // namespace theseus
@@ -35,7 +35,8 @@
 
 /**
  * Class containing the necessary wavefronts to perform backtrace. These wavefronts
- * have to be stored in memory until the end of the alignment.
+ * have to be stored in memory until the end of the alignment, unless only the
+ * score is computed (see discard_scores_before).
  *
  */
 
@@ -53,24 +54,27 @@ public:
         _m_wf.realloc(expected_ncells);
         _m_jumps_wf.realloc(expected_ncells);
         _i_jumps_wf.realloc(expected_ncells);
-        _i2_jumps_wf.realloc(expected_ncells);
 
         _m_wf.set_realloc_policy(dense_wf_realloc_policy);
         _m_jumps_wf.set_realloc_policy(dense_wf_realloc_policy);
         _i_jumps_wf.set_realloc_policy(dense_wf_realloc_policy);
-        _i2_jumps_wf.set_realloc_policy(dense_wf_realloc_policy);
     }
 
     /**
      * @brief Reinitialize the beyond the scope object each time that a new
      * alignment is called.
      *
+     * @param narrow_cells Whether to store the cells with 32-bit prev_pos and
+     * vertex_id columns (see CellVector)
      */
-    void new_alignment() {
+    void new_alignment(bool narrow_cells) {
         _m_wf.clear();
         _m_jumps_wf.clear();
         _i_jumps_wf.clear();
-        _i2_jumps_wf.clear();
+
+        _m_wf.set_narrow(narrow_cells);
+        _m_jumps_wf.set_narrow(narrow_cells);
+        _i_jumps_wf.set_narrow(narrow_cells);
 
         _m_wf_pos.clear();
         _m_jumps_wf_pos.clear();
@@ -86,10 +90,39 @@ public:
     void update_positions() {
         _m_wf_pos.push_back(_m_wf.size());
         _m_jumps_wf_pos.push_back(_m_jumps_wf.size());
-        _i_jumps_wf_pos.push_back(_i2_jumps_wf.size());
+        _i_jumps_wf_pos.push_back(_i_jumps_wf.size());
+    }
+
+    /**
+     * @brief Release the cells computed before score "score", which will not be
+     * accessed again when no backtrace is needed. To move each cell only a
+     * constant number of times, the cells are only released once they are at
+     * least as many as the cells kept.
+     *
+     * @param score
+     */
+    void discard_scores_before(int score) {
+        if (score <= 0) {
+            return;
+        }
+        discard_front(_m_wf, _m_wf_pos[score - 1]);
+        discard_front(_m_jumps_wf, _m_jumps_wf_pos[score - 1]);
+        discard_front(_i_jumps_wf, _i_jumps_wf_pos[score - 1]);
     }
 
 
+    /**
+     * @brief Number of cells kept (those not released by
+     * discard_scores_before).
+     *
+     * @return int64_t
+     */
+    int64_t num_cells() const {
+        return (_m_wf.size() - _m_wf.origin()) +
+               (_m_jumps_wf.size() - _m_jumps_wf.origin()) +
+               (_i_jumps_wf.size() - _i_jumps_wf.origin());
+    }
+
     /**
      * @brief Access the i_jumps wavefront
      *
@@ -149,10 +182,16 @@ private:
         return required_size * 2;
     };
 
+    static void discard_front(Cell::CellVector &wf, Cell::CellVector::size_type first_kept) {
+        const auto ndiscard = first_kept - wf.origin();
+        if (2 * ndiscard >= wf.size() - wf.origin()) {
+            wf.discard_front(first_kept);
+        }
+    }
+
     Cell::CellVector _m_wf;        // M structure backtrace wavefront
     Cell::CellVector _m_jumps_wf;  // M Jumps structure backtrace wavefront
     Cell::CellVector _i_jumps_wf;  // I Jumps structure backtrace wavefront
-    Cell::CellVector _i2_jumps_wf; // I2 Jumps structure backtrace wavefront
 
     // Vectors to know the span of cells associated to each score
     std::vector<int> _m_wf_pos;
@@ -28,7 +28,11 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
 #include <type_traits>
 #include <typeinfo>
 
@@ -60,10 +64,12 @@ constexpr ptrdiff_t realloc_wavefront_policy(// std::ptrdiff_t capacity,
     return required_size * 1.5;
 };
 
+class CellVector;
+
 // WARNING: We want Cell to be a simple struct so it is standard layout and
 // trivial. This way, resizes of Vector<Cell> are free.
 struct Cell {
-    using CellVector = Vector<Cell, true>;
+    using CellVector = theseus::CellVector;
 
     using vertex_t = NodeId;
     using idx2d_t = int32_t;
@@ -95,4 +101,291 @@ struct Cell {
     Matrix from_matrix;
 };
 
+/**
+ * Vector of cells stored as a structure of arrays: one column per field of
+ * Cell. Kernels that only look at offsets and diagonals (sparsify, jump
+ * checks, heuristics) then stream through two dense int32 arrays instead of
+ * 32-byte cells. Cells are read by value with operator[], and offsets and
+ * diagonals can also be accessed (and modified) through column accessors.
+ *
+ * The prev_pos and vertex_id columns have a narrow (32-bit) and a wide
+ * (64-bit) representation, chosen with set_narrow while the vector is empty.
+ * A narrow vector takes 17 bytes per cell instead of 25, and is promoted to
+ * the wide representation as soon as a cell does not fit in it.
+ *
+ * The first cells can be released with discard_front. Positions are not
+ * renumbered: the discarded cells just cannot be accessed anymore.
+ *
+ */
+class CellVector {
+public:
+    using size_type = std::ptrdiff_t;
+    using realloc_policy = std::function<size_type(size_type, size_type)>;
+
+    using narrow_pos_t = int32_t;
+    using narrow_vertex_t = uint32_t;
+
+    /**
+     * @brief Get the number of cells.
+     *
+     * @return size_type
+     */
+    size_type size() const noexcept { return _origin + _offset.size(); }
+
+    /**
+     * @brief Check if the vector has no cells.
+     *
+     * @return true if there are no cells, false otherwise.
+     */
+    bool empty() const noexcept { return size() == 0; }
+
+    /**
+     * @brief Get the position of the first cell that has not been discarded.
+     *
+     * @return size_type
+     */
+    size_type origin() const noexcept { return _origin; }
+
+    /**
+     * @brief Check if the prev_pos and vertex_id columns use 32-bit values.
+     *
+     * @return true if the vector is narrow, false otherwise.
+     */
+    bool is_narrow() const noexcept { return _narrow; }
+
+    /**
+     * @brief Choose the representation of the prev_pos and vertex_id columns.
+     * The memory of the unused representation is released. Should only be
+     * called on an empty vector.
+     *
+     * @param narrow
+     */
+    void set_narrow(bool narrow) {
+        if (narrow == _narrow) {
+            return;
+        }
+        const size_type capacity = _offset.capacity();
+        _narrow = narrow;
+        if (_narrow) {
+            _prev_pos.realloc(0);
+            _vertex_id.realloc(0);
+            _prev_pos32.realloc(capacity);
+            _vertex_id32.realloc(capacity);
+        }
+        else {
+            _prev_pos32.realloc(0);
+            _vertex_id32.realloc(0);
+            _prev_pos.realloc(capacity);
+            _vertex_id.realloc(capacity);
+        }
+    }
+
+    /**
+     * @brief Reserve space for new_capacity cells in every column.
+     *
+     * @param new_capacity
+     */
+    void realloc(size_type new_capacity) {
+        if (_narrow) {
+            _prev_pos32.realloc(new_capacity);
+            _vertex_id32.realloc(new_capacity);
+        }
+        else {
+            _prev_pos.realloc(new_capacity);
+            _vertex_id.realloc(new_capacity);
+        }
+        _offset.realloc(new_capacity);
+        _diag.realloc(new_capacity);
+        _from_matrix.realloc(new_capacity);
+    }
+
+    /**
+     * @brief Set the reallocation policy of every column.
+     *
+     * @param policy
+     */
+    void set_realloc_policy(const realloc_policy &policy) {
+        _prev_pos.set_realloc_policy(policy);
+        _vertex_id.set_realloc_policy(policy);
+        _prev_pos32.set_realloc_policy(policy);
+        _vertex_id32.set_realloc_policy(policy);
+        _offset.set_realloc_policy(policy);
+        _diag.set_realloc_policy(policy);
+        _from_matrix.set_realloc_policy(policy);
+    }
+
+    /**
+     * @brief Resize every column. New cells are left uninitialized. The new
+     * size cannot be smaller than origin().
+     *
+     * @param new_size
+     */
+    void resize(size_type new_size) {
+        new_size -= _origin;
+        if (_narrow) {
+            _prev_pos32.resize(new_size);
+            _vertex_id32.resize(new_size);
+        }
+        else {
+            _prev_pos.resize(new_size);
+            _vertex_id.resize(new_size);
+        }
+        _offset.resize(new_size);
+        _diag.resize(new_size);
+        _from_matrix.resize(new_size);
+    }
+
+    /**
+     * @brief Remove all the cells, keeping the allocated memory.
+     *
+     */
+    void clear() noexcept {
+        _origin = 0;
+        _prev_pos.clear();
+        _vertex_id.clear();
+        _prev_pos32.clear();
+        _vertex_id32.clear();
+        _offset.clear();
+        _diag.clear();
+        _from_matrix.clear();
+    }
+
+    /**
+     * @brief Release the cells before position new_origin, keeping the
+     * positions of the rest. Nothing is done if they were already released.
+     *
+     * @param new_origin
+     */
+    void discard_front(size_type new_origin) {
+        const size_type ndiscard = new_origin - _origin;
+        if (ndiscard <= 0) {
+            return;
+        }
+        const size_type nkeep = _offset.size() - ndiscard;
+        if (_narrow) {
+            discard_column(_prev_pos32, ndiscard, nkeep);
+            discard_column(_vertex_id32, ndiscard, nkeep);
+        }
+        else {
+            discard_column(_prev_pos, ndiscard, nkeep);
+            discard_column(_vertex_id, ndiscard, nkeep);
+        }
+        discard_column(_offset, ndiscard, nkeep);
+        discard_column(_diag, ndiscard, nkeep);
+        discard_column(_from_matrix, ndiscard, nkeep);
+        _origin = new_origin;
+    }
+
+    /**
+     * @brief Append a cell at the end of the vector.
+     *
+     * @param cell
+     */
+    void push_back(const Cell &cell) {
+        if (_narrow) {
+            if (!fits_narrow(cell)) [[unlikely]] {
+                widen();
+                push_back(cell);
+                return;
+            }
+            _prev_pos32.push_back(static_cast<narrow_pos_t>(cell.prev_pos));
+            _vertex_id32.push_back(static_cast<narrow_vertex_t>(cell.vertex_id));
+        }
+        else {
+            _prev_pos.push_back(cell.prev_pos);
+            _vertex_id.push_back(cell.vertex_id);
+        }
+        _offset.push_back(cell.offset);
+        _diag.push_back(cell.diag);
+        _from_matrix.push_back(cell.from_matrix);
+    }
+
+    /**
+     * @brief Get a copy of the cell at position pos.
+     *
+     * @param pos
+     * @return Cell
+     */
+    Cell operator[](size_type pos) const {
+        return Cell{prev_pos(pos), vertex_id(pos), offset(pos), diag(pos), from_matrix(pos)};
+    }
+
+    // Column accessors
+    Cell::idx2d_t &offset(size_type pos) { return _offset[pos - _origin]; }
+    Cell::idx2d_t &diag(size_type pos) { return _diag[pos - _origin]; }
+
+    Cell::pos_t prev_pos(size_type pos) const {
+        pos -= _origin;
+        return _narrow ? static_cast<Cell::pos_t>(_prev_pos32[pos]) : _prev_pos[pos];
+    }
+    Cell::vertex_t vertex_id(size_type pos) const {
+        pos -= _origin;
+        return _narrow ? static_cast<Cell::vertex_t>(_vertex_id32[pos]) : _vertex_id[pos];
+    }
+    Cell::idx2d_t offset(size_type pos) const { return _offset[pos - _origin]; }
+    Cell::idx2d_t diag(size_type pos) const { return _diag[pos - _origin]; }
+    Cell::Matrix from_matrix(size_type pos) const { return _from_matrix[pos - _origin]; }
+
+    // Raw columns, for kernels that stream through offsets and diagonals. The
+    // first element is the cell at position origin().
+    const Cell::idx2d_t *offsets() const noexcept { return _offset.data(); }
+    const Cell::idx2d_t *diags() const noexcept { return _diag.data(); }
+
+private:
+    /**
+     * @brief Check if the prev_pos and vertex_id of a cell fit in the narrow
+     * columns.
+     *
+     * @param cell
+     * @return true if the cell fits, false otherwise.
+     */
+    static bool fits_narrow(const Cell &cell) {
+        return cell.prev_pos >= std::numeric_limits<narrow_pos_t>::min() &&
+               cell.prev_pos <= std::numeric_limits<narrow_pos_t>::max() &&
+               cell.vertex_id <= std::numeric_limits<narrow_vertex_t>::max();
+    }
+
+    /**
+     * @brief Move the prev_pos and vertex_id columns to the wide representation.
+     *
+     */
+    void widen() {
+        const size_type n = _offset.size();
+        _prev_pos.realloc(std::max(_offset.capacity(), n + 1));
+        _vertex_id.realloc(std::max(_offset.capacity(), n + 1));
+        _prev_pos.resize(n);
+        _vertex_id.resize(n);
+        for (size_type l = 0; l < n; ++l) {
+            _prev_pos[l] = _prev_pos32[l];
+            _vertex_id[l] = _vertex_id32[l];
+        }
+        _prev_pos32.clear();
+        _vertex_id32.clear();
+        _prev_pos32.realloc(0);
+        _vertex_id32.realloc(0);
+        _narrow = false;
+    }
+
+    /**
+     * @brief Move the last nkeep elements of a column to its front.
+     *
+     */
+    template <typename T>
+    static void discard_column(Vector<T, true> &column, size_type ndiscard, size_type nkeep) {
+        std::memmove(column.data(), column.data() + ndiscard, nkeep * sizeof(T));
+        column.resize(nkeep);
+    }
+
+    bool _narrow = false;
+    size_type _origin = 0;   // Position of the first stored cell
+
+    Vector<Cell::pos_t, true> _prev_pos;
+    Vector<Cell::vertex_t, true> _vertex_id;
+    Vector<narrow_pos_t, true> _prev_pos32;
+    Vector<narrow_vertex_t, true> _vertex_id32;
+    Vector<Cell::idx2d_t, true> _offset;
+    Vector<Cell::idx2d_t, true> _diag;
+    Vector<Cell::Matrix, true> _from_matrix;
+};
+
 }   // namespace theseus
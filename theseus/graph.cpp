@@ -1,9 +1,11 @@
 #include "../include/theseus/graph.h"
 
 #include <algorithm>
+#include <map>
 #include <string>
 #include <vector>
 #include <ranges>
+#include <variant>
 
 namespace theseus {
 
@@ -71,6 +73,12 @@ public:
         free_node_ids_ = other.free_node_ids_;
         source_nodes_ = other.source_nodes_;
         sink_nodes_ = other.sink_nodes_;
+        packed_ = other.packed_;
+        packed_seqs_ = other.packed_seqs_;
+        packed_garbage_ = other.packed_garbage_;
+        total_length_ = other.total_length_;
+        nedges_ = other.nedges_;
+        size_counts_ = other.size_counts_;
     }
 
     NodeId add_node(std::string_view sequence) {
@@ -84,18 +92,27 @@ public:
             id = free_node_ids_.back();
             free_node_ids_.pop_back();
 
-            nodes_[id].sequence = std::move(sequence);
             nodes_[id].alive = true;
         }
         else {
             id = nodes_.size();
 
-            nodes_.emplace_back(Node{std::move(sequence), {}, {}, true});
+            nodes_.emplace_back(Node{{}, {}, {}, true});
+        }
+
+        if (packed_) {
+            nodes_[id].sequence = PackedRange{packed_seqs_.size(), sequence.size()};
+            packed_seqs_.append(sequence);
+        }
+        else {
+            nodes_[id].sequence = std::move(sequence);
         }
 
         source_nodes_.push_back(id);
         sink_nodes_.push_back(id);
 
+        node_added(node_size(id));
+
         return id;
     }
 
@@ -104,7 +121,14 @@ public:
             throw Graph::InvalidNodeException(id);
         }
 
-        nodes_[id].sequence.append(suffix);
+        const size_t old_size = node_size(id);
+        if (packed_) {
+            append_packed(std::get<PackedRange>(nodes_[id].sequence), suffix);
+        }
+        else {
+            std::get<std::string>(nodes_[id].sequence).append(suffix);
+        }
+        node_resized(old_size, node_size(id));
     }
 
     std::string split_sequence(NodeId id, size_t idx) {
@@ -112,8 +136,21 @@ public:
             throw Graph::InvalidNodeException(id);
         }
 
-        std::string new_seq = nodes_[id].sequence.substr(idx);
-        nodes_[id].sequence.resize(idx);
+        const size_t old_size = node_size(id);
+        std::string new_seq;
+        if (packed_) {
+            PackedRange &range = std::get<PackedRange>(nodes_[id].sequence);
+            if (idx < range.size) {
+                new_seq = packed_seqs_.unpack(range.offset + idx, range.size - idx);
+                release_packed(range, idx);
+            }
+        }
+        else {
+            std::string &seq = std::get<std::string>(nodes_[id].sequence);
+            new_seq = seq.substr(idx);
+            seq.resize(idx);
+        }
+        node_resized(old_size, node_size(id));
 
         return new_seq;
     }
@@ -131,6 +168,11 @@ public:
             remove_id_from_vec(sink_nodes_, id);
         }
 
+        // Self-loops are in both lists
+        nedges_ -= nodes_[id].out_nodes.size() + nodes_[id].in_nodes.size() -
+                   std::ranges::count(nodes_[id].out_nodes, id);
+        node_removed(node_size(id));
+
         for (NodeId out_id : nodes_[id].out_nodes) {
             remove_id_from_vec(nodes_[out_id].in_nodes, id);
         }
@@ -139,7 +181,12 @@ public:
             remove_id_from_vec(nodes_[in_id].out_nodes, id);
         }
 
-        nodes_[id].sequence.clear();
+        if (packed_) {
+            release_packed(std::get<PackedRange>(nodes_[id].sequence), 0);
+        }
+        else {
+            nodes_[id].sequence = std::string();
+        }
         nodes_[id].in_nodes.clear();
         nodes_[id].out_nodes.clear();
         nodes_[id].alive = false;
@@ -157,6 +204,7 @@ public:
 
         nodes_[from].out_nodes.push_back(to);
         nodes_[to].in_nodes.push_back(from);
+        nedges_ += 1;
 
         remove_id_from_vec(source_nodes_, to);
         remove_id_from_vec(sink_nodes_, from);
@@ -173,6 +221,7 @@ public:
         bool removed = remove_id_from_vec(nodes_[from].out_nodes, to);
         if (removed) {
             remove_id_from_vec(nodes_[to].in_nodes, from);
+            nedges_ -= 1;
 
             if (nodes_[from].out_nodes.empty()) {
                 sink_nodes_.push_back(from);
@@ -198,6 +247,7 @@ public:
             }
         }
 
+        nedges_ -= nodes_[from].out_nodes.size();
         nodes_[from].out_nodes.clear();
 
         if (!is_sink(from)) {
@@ -218,6 +268,7 @@ public:
             }
         }
 
+        nedges_ -= nodes_[to].in_nodes.size();
         nodes_[to].in_nodes.clear();
 
         if (!is_source(to)) {
@@ -280,7 +331,7 @@ public:
 
         const auto &node = nodes_[id];
         return {
-            Graph::SequenceView(node.sequence, false),
+            sequence_view(node, false),
             Graph::NodeIdRange(node.in_nodes.cbegin(), node.in_nodes.cend()),
             Graph::NodeIdRange(node.out_nodes.cbegin(), node.out_nodes.cend()),
         };
@@ -293,7 +344,7 @@ public:
 
         const auto &node = nodes_[id];
         return {
-            Graph::SequenceView(node.sequence, true),
+            sequence_view(node, true),
             Graph::NodeIdRange(node.out_nodes.cbegin(), node.out_nodes.cend()),
             Graph::NodeIdRange(node.in_nodes.cbegin(), node.in_nodes.cend()),
         };
@@ -327,7 +378,49 @@ public:
         if (!is_valid_node(id)) {
             throw Graph::InvalidNodeException(id);
         }
-        return nodes_[id].sequence.size();
+        return sequence_size(nodes_[id]);
+    }
+
+    int max_node_size() const {
+        return size_counts_.empty() ? 0 : size_counts_.rbegin()->first;
+    }
+
+    size_t total_sequence_length() const {
+        return total_length_;
+    }
+
+    size_t nedges() const {
+        return nedges_;
+    }
+
+    void pack_sequences() {
+        if (packed_) {
+            return;
+        }
+        for (auto &node : nodes_) {
+            const std::string &seq = std::get<std::string>(node.sequence);
+            PackedRange range{packed_seqs_.size(), seq.size()};
+            packed_seqs_.append(seq);
+            node.sequence = range;  // Releases the unpacked storage
+        }
+        packed_ = true;
+    }
+
+    bool is_packed() const {
+        return packed_;
+    }
+
+    size_t memory_bytes() const {
+        size_t bytes = nodes_.capacity() * sizeof(Node) + packed_seqs_.memory_bytes() +
+                       (free_node_ids_.capacity() + source_nodes_.capacity() + sink_nodes_.capacity()) * sizeof(NodeId);
+        const size_t inline_capacity = std::string().capacity();
+        for (const auto &node : nodes_) {
+            bytes += (node.in_nodes.capacity() + node.out_nodes.capacity()) * sizeof(NodeId);
+            if (const std::string *seq = std::get_if<std::string>(&node.sequence)) {
+                bytes += (seq->capacity() > inline_capacity) ? seq->capacity() + 1 : 0;
+            }
+        }
+        return bytes;
     }
 
     NodeIdRange source_nodes() const {
@@ -345,8 +438,7 @@ public:
         std::cout << "]\n";
 
         for (long unsigned int i = 0; i < nodes_.size(); ++i) {
-            auto node = nodes_[i];
-            std::cout << "  \\node (n" << i << ") at (" << (i * 3) << ",0) {" << i << ": " << node.sequence << "};\n";
+            std::cout << "  \\node (n" << i << ") at (" << (i * 3) << ",0) {" << i << ": " << sequence_view(nodes_[i], false) << "};\n";
         }
 
         for (long unsigned int i = 0; i < nodes_.size(); ++i) {
@@ -360,8 +452,15 @@ public:
     }
 
 private:
+    // Bases [offset, offset + size) of packed_seqs_
+    struct PackedRange {
+        size_t offset;
+        size_t size;
+    };
+
     struct Node {
-        std::string sequence;
+        // The sequence itself, or where it is in packed_seqs_ if the graph is packed
+        std::variant<std::string, PackedRange> sequence;
         std::vector<NodeId> in_nodes;
         std::vector<NodeId> out_nodes;
         bool alive;
@@ -374,6 +473,136 @@ private:
     std::vector<NodeId> source_nodes_;
     std::vector<NodeId> sink_nodes_;
 
+    bool packed_ = false;   // Whether node sequences are stored packed
+
+    // Sequences of the nodes of a packed graph, one after the other
+    PackedSequence packed_seqs_;
+    size_t packed_garbage_ = 0;  // Bases of packed_seqs_ no longer used by a node
+
+    // Size statistics, updated as the graph is modified. The const accessors
+    // only read them, so a graph shared by several threads is never written.
+    size_t total_length_ = 0;               // Sum of the node lengths
+    size_t nedges_ = 0;                     // Number of edges
+    std::map<size_t, size_t> size_counts_;  // Number of nodes of each length
+
+    /**
+     * Update the size statistics after adding a node.
+     *
+     * @param size Length of the new node.
+     */
+    void node_added(size_t size) {
+        total_length_ += size;
+        ++size_counts_[size];
+    }
+
+    /**
+     * Update the size statistics after removing a node.
+     *
+     * @param size Length of the removed node.
+     */
+    void node_removed(size_t size) {
+        total_length_ -= size;
+        auto it = size_counts_.find(size);
+        if (--it->second == 0) {
+            size_counts_.erase(it);
+        }
+    }
+
+    /**
+     * Update the size statistics after changing the length of a node.
+     *
+     * @param old_size Previous length of the node.
+     * @param new_size New length of the node.
+     */
+    void node_resized(size_t old_size, size_t new_size) {
+        if (old_size != new_size) {
+            node_removed(old_size);
+            node_added(new_size);
+        }
+    }
+
+    /**
+     * Get a view of the sequence of a node, whatever its storage.
+     *
+     * @param node The node.
+     * @param reversed Whether the view is reversed.
+     * @return A view of the sequence of the node.
+     */
+    Graph::SequenceView sequence_view(const Node &node, bool reversed) const {
+        if (packed_) {
+            const PackedRange &range = std::get<PackedRange>(node.sequence);
+            return Graph::SequenceView(&packed_seqs_, range.offset, range.size, reversed);
+        }
+        return Graph::SequenceView(std::get<std::string>(node.sequence), reversed);
+    }
+
+    /**
+     * Get the length of the sequence of a node, whatever its storage.
+     *
+     * @param node The node.
+     * @return The length of the sequence of the node.
+     */
+    static size_t sequence_size(const Node &node) {
+        if (const PackedRange *range = std::get_if<PackedRange>(&node.sequence)) {
+            return range->size;
+        }
+        return std::get<std::string>(node.sequence).size();
+    }
+
+    /**
+     * Append characters to a packed node sequence. Unless the sequence is the
+     * last one of packed_seqs_, it is first moved to the end.
+     *
+     * @param range The packed node sequence.
+     * @param suffix The characters to append.
+     */
+    void append_packed(PackedRange &range, std::string_view suffix) {
+        if (range.offset + range.size != packed_seqs_.size()) {
+            const std::string seq = packed_seqs_.unpack(range.offset, range.size);
+            packed_garbage_ += range.size;
+            range.offset = packed_seqs_.size();
+            packed_seqs_.append(seq);
+        }
+        packed_seqs_.append(suffix);
+        range.size += suffix.size();
+        compact_packed_if_needed();
+    }
+
+    /**
+     * Shrink a packed node sequence to its first new_size bases.
+     *
+     * @param range The packed node sequence.
+     * @param new_size The new size of the sequence.
+     */
+    void release_packed(PackedRange &range, size_t new_size) {
+        if (range.offset + range.size == packed_seqs_.size()) {
+            packed_seqs_.truncate(range.offset + new_size);
+        }
+        else {
+            packed_garbage_ += range.size - new_size;
+        }
+        range.size = new_size;
+        compact_packed_if_needed();
+    }
+
+    /**
+     * Repack the node sequences once most of packed_seqs_ is no longer used.
+     */
+    void compact_packed_if_needed() {
+        if (2 * packed_garbage_ <= packed_seqs_.size()) {
+            return;
+        }
+        PackedSequence compacted;
+        for (auto &node : nodes_) {
+            PackedRange &range = std::get<PackedRange>(node.sequence);
+            const std::string seq = packed_seqs_.unpack(range.offset, range.size);
+            range.offset = compacted.size();
+            compacted.append(seq);
+        }
+        packed_seqs_ = std::move(compacted);
+        packed_garbage_ = 0;
+    }
+
     /**
      * Remove the given id from the vector if it exists. Avoid dynamic allocations
      * by swapping the id to remove with the last element and popping the back.
@@ -480,6 +709,18 @@ Graph::NodeIdRange Graph::nodes() const { return impl_->nodes(); }
 
 int Graph::node_size(NodeId id) const { return impl_->node_size(id); }
 
+int Graph::max_node_size() const { return impl_->max_node_size(); }
+
+size_t Graph::total_sequence_length() const { return impl_->total_sequence_length(); }
+
+size_t Graph::nedges() const { return impl_->nedges(); }
+
+void Graph::pack_sequences() { impl_->pack_sequences(); }
+
+bool Graph::is_packed() const { return impl_->is_packed(); }
+
+size_t Graph::memory_bytes() const { return impl_->memory_bytes(); }
+
 Graph::NodeIdRange Graph::source_nodes() const { return impl_->source_nodes(); }
 
 Graph::NodeIdRange Graph::sink_nodes() const { return impl_->sink_nodes(); }
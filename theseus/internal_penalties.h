@@ -28,6 +28,8 @@
 
 #pragma once
 
+#include <stdexcept>
+
 #include "theseus/penalties.h"
 
 /**
@@ -57,20 +59,26 @@ public:
             _gape = penalties.gape();
         }
 
-        if (penalties.match() > penalties.mism()) {
+        _gapo2 = 0;
+        _gape2 = 0;
+
+        // Linear gaps have no gap open penalty
+        const bool linear = penalties.type() == Penalties::Type::Linear;
+        if (penalties.type() == Penalties::Type::DualAffine) {
+            throw std::invalid_argument("Dual affine-gap penalties are not supported yet.");
+        }
+        else if (penalties.match() > penalties.mism()) {
             throw std::invalid_argument("The match penalty must be less than the mismatch penalty");
         }
-        else if (penalties.match() > penalties.gapo()) {
+        else if (!linear && penalties.match() > penalties.gapo()) {
             throw std::invalid_argument("The match penalty must be less than or equal to the gap open penalty.");
         }
         else if (penalties.match() > penalties.gape()) {
             throw std::invalid_argument("The match penalty must be less than or equal to the gap extend penalty.");
         }
-        else if (penalties.gapo() < penalties.gape()) {
+        else if (!linear && penalties.gapo() < penalties.gape()) {
             throw std::invalid_argument("The gap open penalty must be greater than or equal to the gap extension penalty.");
         }
-
-        // TODO: Control for dual affine penalties
     }
 
     /**
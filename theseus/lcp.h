@@ -0,0 +1,241 @@
+/*
+ *                             The MIT License
+ *
+ * Copyright (c) 2024 by Albert Jimenez-Blanco
+ *
+ * This file is part of #################### Theseus Library ####################.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "theseus/packed_sequence.h"
+
+/**
+ * Longest Common Prefix (LCP) kernels used to extend diagonals. Both kernels
+ * return the number of consecutive equal characters of two raw character
+ * arrays, comparing at most "max_len" characters:
+ *
+ * - lcp_forward: compares a[0], a[1], ... against b[0], b[1], ...
+ * - lcp_backward: compares a_end[-1], a_end[-2], ... against b_end[-1],
+ *   b_end[-2], ... This is the access pattern of two reversed SequenceViews.
+ *
+ * The characters are compared in blocks of 32 (AVX2) or 16 (SSE2) bytes when
+ * the target supports it, then in 64-bit words (XOR + count trailing/leading
+ * zeros) and finally one character at a time. Word-at-a-time comparisons
+ * assume a little-endian target, otherwise only the scalar loop is used.
+ *
+ * lcp_packed_forward and lcp_packed_backward are the equivalent kernels for
+ * two PackedSequence objects, comparing 32 bases per 64-bit word.
+ *
+ */
+
+namespace theseus {
+
+/**
+ * @brief Load 8 unaligned bytes as a 64-bit word.
+ *
+ * @param ptr
+ * @return uint64_t
+ */
+inline uint64_t load_word(const char *ptr) {
+    uint64_t word;
+    std::memcpy(&word, ptr, sizeof(word));
+    return word;
+}
+
+/**
+ * @brief Number of matching characters between a[0..max_len) and b[0..max_len),
+ * starting from the first character.
+ *
+ * @param a
+ * @param b
+ * @param max_len
+ * @return int
+ */
+inline int lcp_forward(const char *a, const char *b, int max_len) {
+    int k = 0;
+    if constexpr (std::endian::native == std::endian::little) {
+#if defined(__AVX2__)
+        for (; k + 32 <= max_len; k += 32) {
+            const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + k));
+            const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + k));
+            const uint32_t neq = ~static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb)));
+            if (neq != 0) {
+                return k + std::countr_zero(neq);
+            }
+        }
+#elif defined(__SSE2__)
+        for (; k + 16 <= max_len; k += 16) {
+            const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + k));
+            const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + k));
+            const uint32_t neq = ~static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb))) & 0xFFFFu;
+            if (neq != 0) {
+                return k + std::countr_zero(neq);
+            }
+        }
+#endif
+        for (; k + 8 <= max_len; k += 8) {
+            const uint64_t diff = load_word(a + k) ^ load_word(b + k);
+            if (diff != 0) {
+                return k + (std::countr_zero(diff) >> 3);
+            }
+        }
+    }
+    while (k < max_len && a[k] == b[k]) {
+        ++k;
+    }
+    return k;
+}
+
+/**
+ * @brief Number of matching characters between a_end[-1], a_end[-2], ... and
+ * b_end[-1], b_end[-2], ..., comparing at most max_len characters.
+ *
+ * @param a_end  One past the first character to compare
+ * @param b_end  One past the first character to compare
+ * @param max_len
+ * @return int
+ */
+inline int lcp_backward(const char *a_end, const char *b_end, int max_len) {
+    int k = 0;
+    if constexpr (std::endian::native == std::endian::little) {
+#if defined(__AVX2__)
+        for (; k + 32 <= max_len; k += 32) {
+            const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a_end - k - 32));
+            const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b_end - k - 32));
+            const uint32_t neq = ~static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb)));
+            if (neq != 0) {
+                return k + std::countl_zero(neq);
+            }
+        }
+#elif defined(__SSE2__)
+        for (; k + 16 <= max_len; k += 16) {
+            const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a_end - k - 16));
+            const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b_end - k - 16));
+            const uint16_t neq = ~static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)));
+            if (neq != 0) {
+                return k + std::countl_zero(neq);
+            }
+        }
+#endif
+        for (; k + 8 <= max_len; k += 8) {
+            const uint64_t diff = load_word(a_end - k - 8) ^ load_word(b_end - k - 8);
+            if (diff != 0) {
+                return k + (std::countl_zero(diff) >> 3);
+            }
+        }
+    }
+    while (k < max_len && a_end[-1 - k] == b_end[-1 - k]) {
+        ++k;
+    }
+    return k;
+}
+
+/**
+ * @brief Number of matching bases between a[a_pos..] and b[b_pos..], comparing
+ * at most max_len bases.
+ *
+ * @param a
+ * @param a_pos
+ * @param b
+ * @param b_pos
+ * @param max_len
+ * @return int
+ */
+inline int lcp_packed_forward(const PackedSequence &a, size_t a_pos,
+                              const PackedSequence &b, size_t b_pos,
+                              int max_len) {
+    int k = 0;
+    while (k < max_len) {
+        const int n = std::min(PackedSequence::bases_per_word, max_len - k);
+        const uint64_t diff = a.bases(a_pos + k) ^ b.bases(b_pos + k);
+        const uint32_t exc  = a.exceptions(a_pos + k) | b.exceptions(b_pos + k);
+        const int first_diff = (diff == 0) ? n : std::min(n, std::countr_zero(diff) >> 1);
+        const int first_exc  = (exc == 0)  ? n : std::min(n, std::countr_zero(exc));
+        if (first_diff < first_exc) {
+            return k + first_diff;
+        }
+        k += first_exc;
+        if (first_exc < n) {
+            // Exceptions are compared character by character
+            if (a[a_pos + k] != b[b_pos + k]) {
+                return k;
+            }
+            ++k;
+        }
+    }
+    return max_len;
+}
+
+/**
+ * @brief Number of matching bases between a[a_end - 1], a[a_end - 2], ... and
+ * b[b_end - 1], b[b_end - 2], ..., comparing at most max_len bases.
+ *
+ * @param a
+ * @param a_end  One past the first position to compare
+ * @param b
+ * @param b_end  One past the first position to compare
+ * @param max_len
+ * @return int
+ */
+inline int lcp_packed_backward(const PackedSequence &a, size_t a_end,
+                               const PackedSequence &b, size_t b_end,
+                               int max_len) {
+    int k = 0;
+    while (k < max_len) {
+        const int n = std::min(PackedSequence::bases_per_word, max_len - k);
+        // Block [end - k - n, end - k), shifted so that the first position to
+        // compare (end - k - 1) is in the highest bits
+        uint64_t diff = a.bases(a_end - k - n) ^ b.bases(b_end - k - n);
+        uint32_t exc  = a.exceptions(a_end - k - n) | b.exceptions(b_end - k - n);
+        if (n < PackedSequence::bases_per_word) {
+            diff <<= 2 * (PackedSequence::bases_per_word - n);
+            exc  <<= PackedSequence::bases_per_word - n;
+        }
+        const int first_diff = (diff == 0) ? n : std::min(n, std::countl_zero(diff) >> 1);
+        const int first_exc  = (exc == 0)  ? n : std::min(n, std::countl_zero(exc));
+        if (first_diff < first_exc) {
+            return k + first_diff;
+        }
+        k += first_exc;
+        if (first_exc < n) {
+            // Exceptions are compared character by character
+            if (a[a_end - 1 - k] != b[b_end - 1 - k]) {
+                return k;
+            }
+            ++k;
+        }
+    }
+    return max_len;
+}
+
+} // namespace theseus
@@ -300,58 +300,58 @@ namespace theseus {
             convert_path(backtrace, poa_path, compacted_G, end_column);
             bool new_node_exists = false;
             NodeId new_node_id;
-            long unsigned int k = 0;
             int i = 0, l = 0, prev_v_poa = poa_path[0], new_v_poa = poa_path[0];
-            while (k < backtrace.edit_op.size()) {
-                if (backtrace.edit_op[k] == 'M') {  // Match
-                    prev_v_poa = new_v_poa;
-                    new_v_poa = poa_path[l + 1];
-                    _poa_vertices[new_v_poa].sequence_IDs.push_back(seq_ID);
-                    _poa_vertices[new_v_poa].weight += weight;
-                    update_poa_edge(prev_v_poa, new_v_poa, compacted_G);
-                    i += 1;
-                    l += 1;
-                    new_node_exists = false;
-                }
-                else if (backtrace.edit_op[k] == 'X') { // Mismatch
-                    prev_v_poa = new_v_poa;
-                    new_v_poa = poa_path[l + 1];
-                    update_poa_vertex(new_v_poa, new_node_id, new_seq[i], new_node_exists, compacted_G, seq_ID, weight);
-                    update_poa_edge(prev_v_poa, new_v_poa, compacted_G);
-                    i += 1;
-                    l += 1;
-                }
-                else if (backtrace.edit_op[k] == 'D') { // Deletion
-                    // Add the new vertex
-                    POAVertex new_vertex;
-                    new_vertex.value  = new_seq[i];
-                    new_vertex.sequence_IDs.push_back(seq_ID);
-                    new_vertex.weight = weight;
-                    _poa_vertices.push_back(new_vertex);
-                    // Add/update a new compacted node
-                    if (new_node_exists) {
-                        // Add a character to the existing vertex (the last one in compacted_G)
-                        compacted_G.expand_sequence(new_node_id, std::string(1, new_seq[i]));
-                        _poa_vertices[_poa_vertices.size() - 1].associated_node_compact = new_node_id;
+            for (const CigarRun &run : backtrace.cigar) {
+                for (int r = 0; r < run.length; ++r) {
+                    if (run.op == 'M') {  // Match
+                        prev_v_poa = new_v_poa;
+                        new_v_poa = poa_path[l + 1];
+                        _poa_vertices[new_v_poa].sequence_IDs.push_back(seq_ID);
+                        _poa_vertices[new_v_poa].weight += weight;
+                        update_poa_edge(prev_v_poa, new_v_poa, compacted_G);
+                        i += 1;
+                        l += 1;
+                        new_node_exists = false;
+                    }
+                    else if (run.op == 'X') { // Mismatch
+                        prev_v_poa = new_v_poa;
+                        new_v_poa = poa_path[l + 1];
+                        update_poa_vertex(new_v_poa, new_node_id, new_seq[i], new_node_exists, compacted_G, seq_ID, weight);
+                        update_poa_edge(prev_v_poa, new_v_poa, compacted_G);
+                        i += 1;
+                        l += 1;
+                    }
+                    else if (run.op == 'D') { // Deletion
+                        // Add the new vertex
+                        POAVertex new_vertex;
+                        new_vertex.value  = new_seq[i];
+                        new_vertex.sequence_IDs.push_back(seq_ID);
+                        new_vertex.weight = weight;
+                        _poa_vertices.push_back(new_vertex);
+                        // Add/update a new compacted node
+                        if (new_node_exists) {
+                            // Add a character to the existing vertex (the last one in compacted_G)
+                            compacted_G.expand_sequence(new_node_id, std::string(1, new_seq[i]));
+                            _poa_vertices[_poa_vertices.size() - 1].associated_node_compact = new_node_id;
+                        }
+                        else {
+                            // Add node
+                            new_node_id = compacted_G.add_node(std::string(1, new_seq[i]));
+                            _first_poa_vtx.push_back(_poa_vertices.size() - 1);
+                            // Update the poa graph
+                            _poa_vertices[_poa_vertices.size() - 1].associated_node_compact = new_node_id;
+                            new_node_exists = true;
+                        }
+                        // Add the new edge
+                        prev_v_poa = new_v_poa;
+                        new_v_poa  = _poa_vertices.size() - 1;
+                        update_poa_edge(prev_v_poa, new_v_poa, compacted_G);
+                        i += 1;
                     }
                     else {
-                        // Add node
-                        new_node_id = compacted_G.add_node(std::string(1, new_seq[i]));
-                        _first_poa_vtx.push_back(_poa_vertices.size() - 1);
-                        // Update the poa graph
-                        _poa_vertices[_poa_vertices.size() - 1].associated_node_compact = new_node_id;
-                        new_node_exists = true;
+                        l += 1;
                     }
-                    // Add the new edge
-                    prev_v_poa = new_v_poa;
-                    new_v_poa  = _poa_vertices.size() - 1;
-                    update_poa_edge(prev_v_poa, new_v_poa, compacted_G);
-                    i += 1;
-                }
-                else {
-                    l += 1;
                 }
-                k += 1;
             }
             prev_v_poa = new_v_poa;
             // Add edge to the sink/source node, as no edit operation covers it?
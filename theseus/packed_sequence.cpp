@@ -0,0 +1,120 @@
+/*
+ *                             The MIT License
+ *
+ * Copyright (c) 2024 by Albert Jimenez-Blanco
+ *
+ * This file is part of #################### Theseus Library ####################.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+
+
+#include "theseus/packed_sequence.h"
+
+namespace theseus {
+
+PackedSequence::PackedSequence(std::string_view seq) {
+    assign(seq);
+}
+
+void PackedSequence::assign(std::string_view seq) {
+    words_.clear();
+    exception_mask_.clear();
+    exceptions_.clear();
+    size_ = 0;
+    append(seq);
+}
+
+void PackedSequence::append(std::string_view seq) {
+    const size_t new_size = size_ + seq.size();
+    // One extra padding word, so that a block can always read the next word
+    words_.resize((new_size + bases_per_word - 1) / bases_per_word + 1, 0);
+    if (has_exceptions()) {
+        exception_mask_.resize((new_size + 63) / 64 + 1, 0);
+    }
+
+    for (size_t l = 0; l < seq.size(); ++l) {
+        const size_t pos = size_ + l;
+        int code = encode(seq[l]);
+        if (code < 0) {
+            // First exception: allocate the mask for the whole sequence
+            if (!has_exceptions()) {
+                exception_mask_.assign((new_size + 63) / 64 + 1, 0);
+            }
+            exception_mask_[pos / 64] |= uint64_t{1} << (pos % 64);
+            exceptions_.emplace_back(static_cast<uint64_t>(pos), seq[l]);
+            code = 0;
+        }
+        words_[pos / bases_per_word] |= static_cast<uint64_t>(code) << (2 * (pos % bases_per_word));
+    }
+    size_ = new_size;
+}
+
+void PackedSequence::truncate(size_t new_size) {
+    if (new_size >= size_) {
+        return;
+    }
+
+    // Clear the codes of the removed bases
+    words_.resize((new_size + bases_per_word - 1) / bases_per_word + 1);
+    std::fill(words_.begin() + new_size / bases_per_word + 1, words_.end(), 0);
+    if (new_size % bases_per_word != 0) {
+        words_[new_size / bases_per_word] &= (uint64_t{1} << (2 * (new_size % bases_per_word))) - 1;
+    }
+    else {
+        words_[new_size / bases_per_word] = 0;
+    }
+
+    // Drop the removed exceptions
+    while (!exceptions_.empty() && exceptions_.back().first >= new_size) {
+        exceptions_.pop_back();
+    }
+    if (exceptions_.empty()) {
+        exception_mask_.clear();
+    }
+    else {
+        exception_mask_.resize((new_size + 63) / 64 + 1);
+        std::fill(exception_mask_.begin() + new_size / 64 + 1, exception_mask_.end(), 0);
+        if (new_size % 64 != 0) {
+            exception_mask_[new_size / 64] &= (uint64_t{1} << (new_size % 64)) - 1;
+        }
+        else {
+            exception_mask_[new_size / 64] = 0;
+        }
+    }
+
+    size_ = new_size;
+}
+
+std::string PackedSequence::unpack(size_t pos, size_t count) const {
+    std::string seq;
+    if (pos >= size_) {
+        return seq;
+    }
+    const size_t end = pos + std::min(count, size_ - pos);
+    seq.resize(end - pos);
+    for (size_t l = pos; l < end; ++l) {
+        seq[l - pos] = (*this)[l];
+    }
+    return seq;
+}
+
+}  // namespace theseus
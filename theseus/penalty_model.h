@@ -0,0 +1,173 @@
+/*
+ *                             The MIT License
+ *
+ * Copyright (c) 2024 by Albert Jimenez-Blanco
+ *
+ * This file is part of #################### Theseus Library ####################.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+
+#pragma once
+
+#include <algorithm>
+
+#include "theseus/penalties.h"
+#include "internal_penalties.h"
+
+/**
+ * Penalty models used to instantiate the wavefront kernels. A model gives the
+ * (internal) penalties of the recurrences and the number of scores of the
+ * scope. The penalties of AffineModel are read at run time, while those of
+ * FixedAffineModel are compile-time constants, so the kernels instantiated
+ * with it fold them (and the positions in the scope) into their code.
+ * LinearModel selects the gap-linear kernels, which only keep the M wavefront.
+ *
+ */
+
+namespace theseus {
+
+/**
+ * @brief Affine-gap penalties read at run time.
+ *
+ */
+class AffineModel {
+public:
+    static constexpr Penalties::Type type = Penalties::Type::Affine;
+
+    AffineModel(const InternalPenalties &penalties) :
+        _mismatch(penalties.mism()), _gapo(penalties.gapo()), _gape(penalties.gape()),
+        _nscores(std::max(penalties.gapo() + penalties.gape(), penalties.mism()) + 1) {}
+
+    int mism() const { return _mismatch; }
+    int gapo() const { return _gapo; }
+    int gape() const { return _gape; }
+
+    /**
+     * @brief Number of scores of the scope.
+     *
+     */
+    int nscores() const { return _nscores; }
+
+    /**
+     * @brief Position of score "score" in the scope.
+     *
+     */
+    int scope_pos(int score) const { return score % _nscores; }
+
+private:
+    int _mismatch;
+    int _gapo;
+    int _gape;
+    int _nscores;
+};
+
+/**
+ * @brief Affine-gap penalties fixed at compile time.
+ *
+ */
+template <int Mismatch, int GapOpen, int GapExtend>
+class FixedAffineModel {
+public:
+    static constexpr Penalties::Type type = Penalties::Type::Affine;
+
+    /**
+     * @brief Whether the model can be used with the given internal penalties.
+     *
+     */
+    static bool matches(const InternalPenalties &penalties) {
+        return penalties.mism() == Mismatch && penalties.gapo() == GapOpen && penalties.gape() == GapExtend;
+    }
+
+    static constexpr int mism() { return Mismatch; }
+    static constexpr int gapo() { return GapOpen; }
+    static constexpr int gape() { return GapExtend; }
+
+    static constexpr int nscores() { return std::max(GapOpen + GapExtend, Mismatch) + 1; }
+
+    static constexpr int scope_pos(int score) { return score % nscores(); }
+};
+
+/**
+ * @brief Linear-gap penalties read at run time. Gaps are computed in the M
+ * wavefront directly, so there is no gap open penalty nor I/D wavefronts.
+ *
+ */
+class LinearModel {
+public:
+    static constexpr Penalties::Type type = Penalties::Type::Linear;
+
+    LinearModel(const InternalPenalties &penalties) :
+        _mismatch(penalties.mism()), _gape(penalties.gape()),
+        _nscores(std::max(penalties.gape(), penalties.mism()) + 1) {}
+
+    int mism() const { return _mismatch; }
+    int gapo() const { return 0; }
+    int gape() const { return _gape; }
+
+    /**
+     * @brief Number of scores of the scope.
+     *
+     */
+    int nscores() const { return _nscores; }
+
+    /**
+     * @brief Position of score "score" in the scope.
+     *
+     */
+    int scope_pos(int score) const { return score % _nscores; }
+
+private:
+    int _mismatch;
+    int _gape;
+    int _nscores;
+};
+
+// Default penalties of the library (match 0, mismatch 2, gap open 3, gap extension 1)
+using DefaultAffineModel = FixedAffineModel<2, 3, 1>;
+
+/**
+ * @brief Penalties of an aligner in the forms used while aligning: validated
+ * and converted to the internal penalties once, together with the models of
+ * the kernels. They are shared by the aligners of an AlignerIndex.
+ *
+ */
+struct PenaltyModels {
+    PenaltyModels(const Penalties &user_penalties) :
+        penalties(user_penalties), internal(user_penalties), affine(internal), linear(internal),
+        linear_gaps(user_penalties.type() == Penalties::Type::Linear),
+        default_affine(!linear_gaps && DefaultAffineModel::matches(internal)) {}
+
+    /**
+     * @brief Number of scores of the scope.
+     *
+     */
+    int nscores() const { return linear_gaps ? linear.nscores() : affine.nscores(); }
+
+    Penalties penalties;            // User defined penalties
+    InternalPenalties internal;     // Penalties of the recurrences
+    AffineModel affine;             // Penalties of the kernels read at run time
+    LinearModel linear;             // Penalties of the gap-linear kernels
+    bool linear_gaps;               // Whether the gap-linear kernels are used
+    bool default_affine;            // Whether the kernels of DefaultAffineModel can be used
+};
+
+}   // namespace theseus
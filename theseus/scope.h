@@ -34,7 +34,8 @@
 /**
  * The scope class manages the temporary wavefront data used during alignment.
  * That is, it stores the wavefronts and position vectors for each score in a
- * circular queue.
+ * circular queue. Only the I and D matrices of the affine-gap recurrences are
+ * stored (M cells are kept by BeyondScope).
  *
  */
 
@@ -75,71 +76,97 @@ public:
     /**
      * @brief Restore data for a new alignment.
      *
+     * @param narrow_cells Whether to store the cells with 32-bit prev_pos and
+     * vertex_id columns (see CellVector)
      */
-    void new_alignment() {
+    void new_alignment(bool narrow_cells) {
         for (int i = 0; i < _squeue.size(); ++i) {
-            _squeue[i].resize(0);
+            _squeue[i].reset();
+            _squeue[i].set_narrow(narrow_cells);
         }
     }
 
     /**
      * @brief Reinitialize data for a new score. As the scope works as a circular
      * queue, the previously stored data in a position of the scope is not relevant
-     * anymore and its contents should be reset to be reused again.
+     * anymore and its contents should be reset to be reused again. Only the
+     * ranges of the vertices stored at that position are reset, so the cost
+     * does not depend on the number of vertices activated so far.
      *
      */
     void new_score(int score) {
-        _squeue[score%_squeue.size()].resize(0);
+        _squeue[score%_squeue.size()].new_score();
     }
 
     /**
-     * @brief Get the size of the scope.
+     * @brief Make room for the ranges of the first "num_vertices" vertices at
+     * score "score". The ranges of the vertices not stored are empty.
      *
-     * @return int
+     * @param score
+     * @param num_vertices
      */
-    int size() {
-        return _squeue.size();
+    void reserve_ranges(int score, int num_vertices) {
+        _squeue[score%_squeue.size()].reserve_ranges(num_vertices);
     }
 
-
     /**
-     * @brief Get the data from the wavefront I of score "score".
+     * @brief Store the ranges of the I, D and M cells of a vertex at score "score".
      *
      * @param score
-     * @return Cell::CellVector&
+     * @param vertex  Index of the vertex in the active vertices
+     * @param i_range
+     * @param d_range
+     * @param m_range
      */
-    Cell::CellVector &i_wf(int score) {
-        return _squeue[score%_squeue.size()]._i_wf;
+    void set_ranges(int score, int vertex, range i_range, range d_range, range m_range) {
+        ScoreData &sd = _squeue[score%_squeue.size()];
+        sd._i_pos[vertex] = i_range;
+        sd._d_pos[vertex] = d_range;
+        sd._m_pos[vertex] = m_range;
+        sd._stored_vertices.push_back(vertex);
     }
 
     /**
-     * @brief Get the data from the wavefront D of score "score".
+     * @brief Get the size of the scope.
      *
-     * @param score
-     * @return Cell::CellVector&
+     * @return int
      */
-    Cell::CellVector &d_wf(int score) {
-        return _squeue[score%_squeue.size()]._d_wf;
+    int size() {
+        return _squeue.size();
     }
 
+
     /**
-     * @brief Get the data from the wavefront I2 of score "score".
+     * @brief Number of cells stored in the scope.
+     *
+     * @return int64_t
+     */
+    int64_t num_cells() {
+        int64_t ncells = 0;
+        for (int i = 0; i < _squeue.size(); ++i) {
+            ncells += _squeue[i]._i_wf.size() + _squeue[i]._d_wf.size();
+        }
+        return ncells;
+    }
+
+    /**
+     * @brief Get the data from the wavefront I of score "score".
      *
      * @param score
      * @return Cell::CellVector&
      */
-    Cell::CellVector &i2_wf(int score) {
-        return _squeue[score%_squeue.size()]._i2_wf;
+    Cell::CellVector &i_wf(int score) {
+        return _squeue[score%_squeue.size()]._i_wf;
     }
 
     /**
-     * @brief Get the data from the wavefront D2 of score "score".
+     * @brief Get the data from the wavefront D of score "score".
      *
      * @param score
      * @return Cell::CellVector&
      */
-    Cell::CellVector &d2_wf(int score) {
-        return _squeue[score%_squeue.size()]._d2_wf;
+    Cell::CellVector &d_wf(int score) {
+        return _squeue[score%_squeue.size()]._d_wf;
     }
 
     /**
@@ -162,16 +189,6 @@ public:
         return _squeue[score%_squeue.size()]._i_pos;
     }
 
-    /**
-     * @brief Get the data from the vector of I2 positions at score "score".
-     *
-     * @param score
-     * @return RangeVector&
-     */
-    RangeVector &i2_pos(int score) {
-        return _squeue[score%_squeue.size()]._i2_pos;
-    }
-
     /**
      * @brief Get the data from the vector of D positions at score "score".
      *
@@ -183,13 +200,38 @@ public:
     }
 
     /**
-     * @brief Get the data from the vector of D2 positions at score "score".
+     * @brief Same accessors as above, with the position of score "score" in
+     * the scope given by the penalty model of the kernels (see
+     * penalty_model.h). The number of scores of a FixedAffineModel is a
+     * compile-time constant, so its kernels do not compute a run-time modulo.
+     * The scope must have been built with model.nscores() scores.
      *
+     * @param model
      * @param score
-     * @return RangeVector&
      */
-    RangeVector &d2_pos(int score) {
-        return _squeue[score%_squeue.size()]._d2_pos;
+    template <typename Model>
+    Cell::CellVector &i_wf(const Model &model, int score) {
+        return _squeue[model.scope_pos(score)]._i_wf;
+    }
+
+    template <typename Model>
+    Cell::CellVector &d_wf(const Model &model, int score) {
+        return _squeue[model.scope_pos(score)]._d_wf;
+    }
+
+    template <typename Model>
+    RangeVector &m_pos(const Model &model, int score) {
+        return _squeue[model.scope_pos(score)]._m_pos;
+    }
+
+    template <typename Model>
+    RangeVector &i_pos(const Model &model, int score) {
+        return _squeue[model.scope_pos(score)]._i_pos;
+    }
+
+    template <typename Model>
+    RangeVector &d_pos(const Model &model, int score) {
+        return _squeue[model.scope_pos(score)]._d_pos;
     }
 
 private:
@@ -202,52 +244,64 @@ private:
         Cell::CellVector _i_wf;
         Cell::CellVector _d_wf;
 
-        Cell::CellVector _i2_wf;
-        Cell::CellVector _d2_wf;
-
         RangeVector _m_pos;
 
         RangeVector _i_pos;
-        RangeVector _i2_pos;
 
         RangeVector _d_pos;
-        RangeVector _d2_pos;
+
+        // Vertices with ranges stored, reset when the score data is reused
+        std::vector<int> _stored_vertices;
 
         ScoreData(int capacity) {
             _i_wf.realloc(capacity);
             _d_wf.realloc(capacity);
-            _i2_wf.realloc(capacity);
-            _d2_wf.realloc(capacity);
 
             _m_pos.realloc(capacity);
             _i_pos.realloc(capacity);
-            _i2_pos.realloc(capacity);
             _d_pos.realloc(capacity);
-            _d2_pos.realloc(capacity);
 
             _i_wf.set_realloc_policy(realloc_policy);
             _d_wf.set_realloc_policy(realloc_policy);
-            _i2_wf.set_realloc_policy(realloc_policy);
-            _d2_wf.set_realloc_policy(realloc_policy);
 
             _m_pos.set_realloc_policy(realloc_policy);
             _i_pos.set_realloc_policy(realloc_policy);
-            _i2_pos.set_realloc_policy(realloc_policy);
             _d_pos.set_realloc_policy(realloc_policy);
-            _d2_pos.set_realloc_policy(realloc_policy);
         }
 
-        void resize(int new_size) {
-            _i_wf.resize(new_size);
-            _d_wf.resize(new_size);
-            _i2_wf.resize(new_size);
-            _d2_wf.resize(new_size);
-
-            _m_pos.resize(new_size);
-            _i_pos.resize(new_size);
-            _i2_pos.resize(new_size);
-            _d_pos.resize(new_size);
-            _d2_pos.resize(new_size);
+        void reset() {
+            _i_wf.resize(0);
+            _d_wf.resize(0);
+
+            _m_pos.resize(0);
+            _i_pos.resize(0);
+            _d_pos.resize(0);
+            _stored_vertices.clear();
+        }
+
+        void new_score() {
+            _i_wf.resize(0);
+            _d_wf.resize(0);
+
+            for (int vertex : _stored_vertices) {
+                _m_pos[vertex] = range{0, 0};
+                _i_pos[vertex] = range{0, 0};
+                _d_pos[vertex] = range{0, 0};
+            }
+            _stored_vertices.clear();
+        }
+
+        void reserve_ranges(int num_vertices) {
+            if (_m_pos.size() < num_vertices) {
+                _m_pos.resize(num_vertices, range{0, 0});
+                _i_pos.resize(num_vertices, range{0, 0});
+                _d_pos.resize(num_vertices, range{0, 0});
+            }
+        }
+
+        void set_narrow(bool narrow) {
+            _i_wf.set_narrow(narrow);
+            _d_wf.set_narrow(narrow);
         }
     };
 
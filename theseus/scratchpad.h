@@ -28,9 +28,9 @@
 
 #pragma once
 
+#include <algorithm>
 #include <span>
 
-#include "wavefront.h"
 #include "cell.h"
 #include "vector.h"
 
@@ -39,6 +39,11 @@
  dp matrix computed. The scratchpad allows to combine (in a process that we call
  sparsify) the data from the depending previous wavefronts yielding a score "s"
  in a given vertex, into a single wavefront containing their maximum offsets.
+
+ Only a window of contiguous diagonals is stored. When the scratchpad is empty
+ (after a reset) the window is moved to wherever the next diagonal is, and it
+ grows when the active diagonals of a vertex do not fit, so its size depends on
+ the width of the wavefronts instead of on the length of the sequences.
 */
 
 namespace theseus {
@@ -51,35 +56,49 @@ public:
     /**
      * @brief Construct a new Scratch Pad object
      *
-     * @param min_diag
-     * @param max_diag
+     * @param capacity Initial number of diagonals of the window
      */
-    ScratchPad(diag_type min_diag, diag_type max_diag) :
-        _wf(min_diag, max_diag, Cell{-1, 0, -1, -1, Cell::Matrix::None}) {
-
-        _diags.realloc(_wf.size());
+    ScratchPad(size_type capacity) {
+        grow(std::max<size_type>(capacity, 1), 0);
     }
 
     // TODO:
     Cell& access_alloc(diag_type diag) {
+        if (!in_window(diag)) [[unlikely]] {
+            move_window(diag);
+        }
         // If the diagonal was not yet in the wavefront (offset is -1), add the
         // diagonal to _diags.
         auto size = _diags.size();
+        Cell &cell = _window[diag - _first_diag];
 
         // We are writing out of boundaries but inside capacity.
         // This is okay with a theseus::vector of trivial types (this is the case).
         _diags[size] = diag;
 
-        size += _wf[diag].offset == -1;
+        size += cell.offset == -1;
 
         _diags.resize_unsafe(size);
 
-        return _wf[diag];
+        return cell;
     }
 
-    // TODO:
-    Cell& operator[](diag_type diag) { return _wf[diag]; }
-    const Cell& operator[](diag_type diag) const { return _wf[diag]; }
+    /**
+     * @brief Merge a cell into its diagonal, keeping the one with the furthest
+     * offset. On ties, the cell already stored is kept.
+     *
+     * @param new_cell
+     */
+    void merge_max(const Cell &new_cell) {
+        auto &cell = access_alloc(new_cell.diag);
+        // If better offset
+        const bool cmp = cell.offset < new_cell.offset;
+        cell = (cmp) ? new_cell : cell;
+    }
+
+    // Only valid for the active diagonals
+    Cell& operator[](diag_type diag) { return _window[diag - _first_diag]; }
+    const Cell& operator[](diag_type diag) const { return _window[diag - _first_diag]; }
 
     /**
      * @brief Return the number of active diagonals in the wavefront. That is,
@@ -92,21 +111,12 @@ public:
     }
 
     /**
-     * @brief Return the minimum diagonal of the wavefront.
-     *
-     * @return diag_type
-     */
-    diag_type min_diag() const {
-        return _wf.min_diag();
-    }
-
-    /**
-     * @brief Return the maximum diagonal of the wavefront.
+     * @brief Return the number of diagonals of the window.
      *
-     * @return diag_type
+     * @return size_type
      */
-    diag_type max_diag() const {
-        return _wf.max_diag();
+    size_type capacity() const {
+        return _window.size();
     }
 
     /**
@@ -126,14 +136,61 @@ public:
      */
     void reset() {
         for (const auto diag : _diags) {
-            _wf[diag].offset = -1;
+            _window[diag - _first_diag].offset = -1;
         }
         _diags.resize(0);
     }
 
 private:
-    Wavefront<Cell> _wf;
+    static constexpr Cell empty_cell{-1, 0, -1, -1, Cell::Matrix::None};
+
+    Vector<Cell, true> _window;     // Diagonals [_first_diag, _first_diag + size)
+    diag_type _first_diag = 0;
     Vector<diag_type, true> _diags;
+
+    bool in_window(diag_type diag) const {
+        return static_cast<size_t>(diag - _first_diag) < static_cast<size_t>(_window.size());
+    }
+
+    /**
+     * @brief Make the window contain "diag". An empty window is just moved
+     * (centered at "diag"), otherwise it grows keeping the active diagonals.
+     *
+     * @param diag
+     */
+    void move_window(diag_type diag) {
+        if (_diags.size() == 0) {
+            _first_diag = diag - _window.size() / 2;
+            return;
+        }
+        const auto [min_it, max_it] = std::minmax_element(_diags.begin(), _diags.end());
+        const diag_type min_diag = std::min(diag, *min_it);
+        const diag_type max_diag = std::max(diag, *max_it);
+        const size_type width = max_diag - min_diag + 1;
+        const size_type new_size = std::max(2 * _window.size(), 2 * width);
+        grow(new_size, min_diag - (new_size - width) / 2);
+    }
+
+    /**
+     * @brief Reallocate the window with "new_size" diagonals starting at
+     * "first_diag", keeping the active diagonals.
+     *
+     * @param new_size
+     * @param first_diag
+     */
+    void grow(size_type new_size, diag_type first_diag) {
+        Vector<Cell, true> window;
+        window.realloc(new_size);
+        window.resize(new_size, empty_cell);
+        for (const auto diag : _diags) {
+            window[diag - first_diag] = _window[diag - _first_diag];
+        }
+        _window = std::move(window);
+        _first_diag = first_diag;
+        // Each diagonal can only be active once (plus the slot written ahead
+        // by access_alloc)
+        _diags.realloc(new_size + 1);
+    }
 };
 
-} // namespace theseus
\ No newline at end of file
+} // namespace theseus
@@ -28,23 +28,30 @@
 
 #include "theseus/theseus_aligner.h"
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
 #include "theseus_aligner_impl.h"
+#include "wave_pool.h"
 
 namespace theseus {
 
 TheseusAligner::TheseusAligner(const Penalties &penalties,
                                const Heuristics &heuristics,
-                               Graph &&graph)
+                               Graph &&graph) : index_(std::make_shared<const AlignerIndex>(penalties, std::move(graph)))
 {
-    aligner_impl_ = std::make_unique<TheseusAlignerImpl>(penalties, heuristics, std::move(graph), 1, false);
+    workspaces_.emplace_back(index_, heuristics);
 }
 
 TheseusAligner::TheseusAligner(const Penalties &penalties,
                                const Heuristics &heuristics,
-                               Graph &graph)
+                               Graph &graph) : index_(std::make_shared<const AlignerIndex>(penalties, graph)) // The index has its own copy of the graph
 {
-    Graph graph_copy = graph; // Make a copy of the graph to ensure that the aligner has its own instance
-    aligner_impl_ = std::make_unique<TheseusAlignerImpl>(penalties, heuristics, std::move(graph_copy), 1, false);
+    workspaces_.emplace_back(index_, heuristics);
 }
 
 TheseusAligner::~TheseusAligner() {}
@@ -55,7 +62,7 @@ void TheseusAligner::print_alignment_as_gaf(
                 std::string seq_name,
                 std::unordered_map<NodeId, std::string> &node_names) {
 
-    aligner_impl_->print_as_gaf(alignment, out_stream, seq_name, node_names);
+    workspaces_.front().aligner_impl_->print_as_gaf(alignment, out_stream, seq_name, node_names);
 }
 
 /**
@@ -66,6 +73,7 @@ void TheseusAligner::print_alignment_as_gaf(
  * @param start_offset
  * @param density_drop_active
  * @param lag_pruning_active
+ * @param ends_free
  * @return Alignment
  */
 Alignment TheseusAligner::align(
@@ -73,9 +81,174 @@ Alignment TheseusAligner::align(
     NodeId &start_node,
     int start_offset,
     bool density_drop_active,
-    bool lag_pruning_active) {
+    bool lag_pruning_active,
+    EndsFree ends_free) {
+
+    return workspaces_.front().align(seq, start_node, start_offset, density_drop_active, lag_pruning_active, ends_free);
+}
+
+/**
+ * @brief Alignment function reusing the buffers of the output alignment.
+ *
+ * @param alignment
+ * @param seq
+ * @param start_node
+ * @param start_offset
+ * @param density_drop_active
+ * @param lag_pruning_active
+ * @param ends_free
+ */
+void TheseusAligner::align_into(
+    Alignment &alignment,
+    std::string_view seq,
+    NodeId start_node,
+    int start_offset,
+    bool density_drop_active,
+    bool lag_pruning_active,
+    EndsFree ends_free) {
+
+    workspaces_.front().align_into(alignment, seq, start_node, start_offset, density_drop_active, lag_pruning_active,
+                                   ends_free);
+}
+
+/**
+ * @brief Multi-threaded alignment of a batch of sequences.
+ *
+ * @param seqs
+ * @param start_nodes
+ * @param start_offsets
+ * @param num_threads
+ * @param density_drop_active
+ * @param lag_pruning_active
+ * @param ends_free
+ * @return std::vector<Alignment>
+ */
+std::vector<Alignment> TheseusAligner::align_batch(
+    std::span<const std::string_view> seqs,
+    std::span<const NodeId> start_nodes,
+    std::span<const int> start_offsets,
+    int num_threads,
+    bool density_drop_active,
+    bool lag_pruning_active,
+    EndsFree ends_free) {
+
+    if (start_nodes.size() != seqs.size() || start_offsets.size() != seqs.size()) {
+        throw std::invalid_argument("[Theseus] align_batch: one start position per sequence is required");
+    }
+    std::vector<Alignment> alignments(seqs.size());
+    if (num_threads <= 0) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // A single thread aligns on the calling thread without the pool
+    if (num_threads == 1 || seqs.size() <= 1) {
+        workspaces_.front().align_batch_into(alignments, seqs, start_nodes, start_offsets,
+                                             density_drop_active, lag_pruning_active, ends_free);
+        return alignments;
+    }
 
-    return aligner_impl_->align(seq, start_node, start_offset, 1, false, false, density_drop_active, lag_pruning_active);
+    // The calling thread aligns with the first workspace, the others with their own
+    const TheseusAlignerImpl &caller_impl = *workspaces_.front().aligner_impl_;
+    while (static_cast<int>(workspaces_.size()) < num_threads) {
+        workspaces_.emplace_back(index_, caller_impl.heuristics());
+    }
+    for (int t = 1; t < num_threads; ++t) {
+        workspaces_[t].set_heuristics(caller_impl.heuristics());
+        workspaces_[t].set_checkpoint_interval(caller_impl.checkpoint_interval());
+        if (workspaces_[t].aligner_impl_->parallel_wave() != caller_impl.parallel_wave()) {
+            workspaces_[t].set_parallel_wave(caller_impl.parallel_wave());
+        }
+    }
+    if (!batch_pool_ || batch_pool_->size() != num_threads) {
+        batch_pool_ = std::make_unique<WavePool>(num_threads);
+    }
+
+    // Each thread takes the next sequence that nobody has taken yet
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    batch_pool_->run(seqs.size(), [&](int lane, size_t i) {
+        if (failed) return;   // Skip the sequences left after an error
+        try {
+            workspaces_[lane].align_into(alignments[i], seqs[i], start_nodes[i], start_offsets[i],
+                                         density_drop_active, lag_pruning_active, ends_free);
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error) error = std::current_exception();
+            failed = true;
+        }
+    });
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return alignments;
+}
+
+/**
+ * @brief Score-only alignment function.
+ *
+ * @param seq
+ * @param start_node
+ * @param start_offset
+ * @param density_drop_active
+ * @param lag_pruning_active
+ * @param ends_free
+ * @return AlignmentScore
+ */
+AlignmentScore TheseusAligner::align_score(
+    std::string_view seq,
+    NodeId start_node,
+    int start_offset,
+    bool density_drop_active,
+    bool lag_pruning_active,
+    EndsFree ends_free) {
+
+    return workspaces_.front().align_score(seq, start_node, start_offset, density_drop_active, lag_pruning_active,
+                                           ends_free);
+}
+
+/**
+ * @brief Linear-memory (bidirectional) alignment function.
+ *
+ * @param seq
+ * @param start_node
+ * @param start_offset
+ * @return Alignment
+ */
+Alignment TheseusAligner::align_bidirectional(
+    std::string_view seq,
+    NodeId start_node,
+    int start_offset) {
+
+    return workspaces_.front().align_bidirectional(seq, start_node, start_offset);
+}
+
+/**
+ * @brief Replace the heuristics of the following alignments.
+ *
+ * @param heuristics
+ */
+void TheseusAligner::set_heuristics(const Heuristics &heuristics) {
+    workspaces_.front().set_heuristics(heuristics);
+}
+
+/**
+ * @brief Set the number of scores between checkpoints of align.
+ *
+ * @param interval
+ */
+void TheseusAligner::set_checkpoint_interval(int interval) {
+    workspaces_.front().set_checkpoint_interval(interval);
+}
+
+/**
+ * @brief Set the number of threads computing the wavefronts of each alignment.
+ *
+ * @param num_threads
+ */
+void TheseusAligner::set_parallel_wave(int num_threads) {
+    workspaces_.front().set_parallel_wave(num_threads);
 }
 
 } // namespace theseus
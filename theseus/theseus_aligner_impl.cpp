@@ -26,6 +26,7 @@
  */
 
 
+#include <cassert>
 #include <string_view>
 #include "theseus_aligner_impl.h"
 
@@ -35,30 +36,42 @@ TheseusAlignerImpl::TheseusAlignerImpl(const Penalties &penalties,
                                        const Heuristics &heuristics,
                                        Graph &&graph,
                                        int initial_weight,
-                                       bool is_msa) :  _penalties(penalties),
-                                                       _internal_penalties(penalties),
-                                                       _heuristics(heuristics),
-                                                       _graph(std::move(graph)),
-                                                       _is_msa(is_msa),
-                                                       _seq("", false) {
-    // TODO: Gap-linear and dual affine-gap.
-    const auto n_scores = std::max({_internal_penalties.gapo() +_internal_penalties.gape(),
-                                  _internal_penalties.gapo() +_internal_penalties.gape(),
-                                  _internal_penalties.mism()}) + 1;
-
-    // POA graph for MSA
-    if (_is_msa) {
-      _poa_graph = std::make_unique<POAGraph>();
-      _poa_graph->create_initial_graph(_graph, initial_weight);
-    }
+                                       bool is_msa) :  TheseusAlignerImpl(std::make_shared<const PenaltyModels>(penalties),
+                                                                          heuristics,
+                                                                          std::make_shared<Graph>(std::move(graph)),
+                                                                          initial_weight,
+                                                                          is_msa) {}
 
+TheseusAlignerImpl::TheseusAlignerImpl(std::shared_ptr<const PenaltyModels> penalties,
+                                       const Heuristics &heuristics,
+                                       std::shared_ptr<const Graph> graph) :  _penalties(std::move(penalties)),
+                                                                              _heuristics(heuristics),
+                                                                              _shared_graph(std::move(graph)),
+                                                                              _graph(*_shared_graph),
+                                                                              _is_msa(false),
+                                                                              _seq("", false) {
     // Initialize aligner parameters and data structures
-    _internal_penalties = InternalPenalties(penalties);
+    const auto n_scores = _penalties->nscores();
     _scope = std::make_unique<Scope>(n_scores);
     _beyond_scope = std::make_unique<BeyondScope>();
     constexpr int expected_nvertices = std::max(1024, 0); // TODO: Set the expected number of vertices
-    _vertices_data = std::make_unique<VerticesData>(penalties, n_scores, expected_nvertices);
-    _scratchpad = std::make_unique<ScratchPad>(-1024, 1024);
+    _vertices_data = std::make_unique<VerticesData>(_penalties->penalties, n_scores, expected_nvertices);
+}
+
+TheseusAlignerImpl::TheseusAlignerImpl(std::shared_ptr<const PenaltyModels> penalties,
+                                       const Heuristics &heuristics,
+                                       std::shared_ptr<Graph> graph,
+                                       int initial_weight,
+                                       bool is_msa) :  TheseusAlignerImpl(std::move(penalties),
+                                                                          heuristics,
+                                                                          std::shared_ptr<const Graph>(graph)) {
+    // POA graph for MSA, which is the only mode that modifies the graph
+    _is_msa = is_msa;
+    if (_is_msa) {
+      _msa_graph = std::move(graph);
+      _poa_graph = std::make_unique<POAGraph>();
+      _poa_graph->create_initial_graph(*_msa_graph, initial_weight);
+    }
 }
 
 // Get the node/reversed node depending on the alignment configuration
@@ -76,30 +89,20 @@ void TheseusAlignerImpl::new_alignment(SequenceView seq,
                                        bool reverse_alignment,
                                        bool density_drop_active,
                                        bool lag_pruning_active) {
-    _scope->new_alignment();
-    _beyond_scope->new_alignment();
+    // Use 32-bit vertex ids and positions in the stored cells when the graph
+    // allows it (the cell vectors are promoted if a position overflows)
+    const bool narrow_cells = _graph.nnodes() <= std::numeric_limits<CellVector::narrow_vertex_t>::max();
+    _scope->new_alignment(narrow_cells);
+    _beyond_scope->new_alignment(narrow_cells);
     _vertices_data->new_alignment();
     _seq = seq;
     _reversed_alignment = reverse_alignment;
-    // Initialize scratchpad
-    int max_diag = 0, v_n;
-    NodeIdRange nodes = _graph.nodes();
-    for (const auto &node : nodes) {
-        v_n = _graph.node_size(node);
-        max_diag = std::max(max_diag, v_n);
-    }
-    const int min_diag = -_seq.size();
-    if (_scratchpad->max_diag() < max_diag ||
-        _scratchpad->min_diag() > min_diag) {
-        // TODO: Compute the max and min with a factor.
-        _scratchpad = std::make_unique<ScratchPad>(min_diag, max_diag);
-    }
     // Set data for first score
     _scope->new_score(_score);
     // Set initial alignment status
     _alignment.theseus_status = THESEUS_STATUS_OK;
     // Set heuristics
-    _heuristics.new_alignment(_internal_penalties.gape(), _seq.size(), density_drop_active, lag_pruning_active);
+    _heuristics.new_alignment(_penalties->internal.gape(), _seq.size(), density_drop_active, lag_pruning_active);
     // TODO: Allow for different initial conditions. Now only global alignment.
     Cell init_condition;
     init_condition.offset    = 0;
@@ -109,48 +112,250 @@ void TheseusAlignerImpl::new_alignment(SequenceView seq,
     // Initial vertex data
     _beyond_scope->m_jumps_wf().push_back(init_condition);
     _vertices_data->activate_vertex(_start_node);
-    _vertices_data->get_vertex_data(_start_node)._m_jumps_positions[0].push_back(0);
+    _vertices_data->add_m_jump(_start_node, 0, 0);
     // Alignment data
     _alignment.path.clear();
-    _alignment.edit_op.clear();
+    _alignment.cigar.clear();
+    _alignment.start_offset = _start_offset;
+    _alignment.query_end = 0;
+    // Extension mode
+    _xdrop_cell.offset = -1;
 }
 
 
 // Process a given vertex with a given _score
-void TheseusAlignerImpl::process_vertex(NodeId curr_node_id) {
+template <typename Model>
+void TheseusAlignerImpl::process_vertex(const Model &model, NodeId curr_node_id) {
 
   // Next
-  int upper_bound = _graph.node_size(curr_node_id);
-  next_I(upper_bound, curr_node_id);
-  _scratchpad->reset();
-  next_D(upper_bound, curr_node_id);
-  _scratchpad->reset();
-  next_M(upper_bound, curr_node_id);
-  _scratchpad->reset();
-  // Extend
   int v_pos = _vertices_data->get_id(curr_node_id);
-  Scope::range cells_range = _scope->m_pos(_score)[v_pos];
+  compute_vertex(model, _lane, curr_node_id);
+  _scope->set_ranges(_score, v_pos, _lane.i_range, _lane.d_range, _lane.m_range);
+  // Keep the vertex live while it stores cells
+  if (_lane.i_range.end > _lane.i_range.start ||
+      _lane.d_range.end > _lane.d_range.start ||
+      _lane.m_range.end > _lane.m_range.start) {
+    _vertices_data->mark_live(v_pos, _score);
+  }
+  // Extend
+  Scope::range cells_range = _lane.m_range;
   for (Cell::pos_t idx = cells_range.start; idx < cells_range.end; ++idx) {
     extend_diagonal(curr_node_id, idx, Cell::Matrix::M);
   }
 }
 
 
+template <typename Model>
+void TheseusAlignerImpl::compute_vertex(const Model &model, WaveLane &lane, NodeId curr_node_id) {
+  int upper_bound = column_bound(curr_node_id);
+  lane.i_range = lane.d_range = Scope::range{0, 0};
+  if constexpr (Model::type == Penalties::Type::Linear) {
+    next_M_linear(model, lane, upper_bound, curr_node_id);
+    lane.scratchpad->reset();
+  }
+  else {
+    next_I(model, lane, upper_bound, curr_node_id);
+    lane.scratchpad->reset();
+    next_D(model, lane, upper_bound, curr_node_id);
+    lane.scratchpad->reset();
+    next_M(model, lane, upper_bound, curr_node_id);
+    lane.scratchpad->reset();
+  }
+  // Extend within the vertex (the merge follows the jumps)
+  if (lane.concurrent) {
+    NodeView curr_node = get_node(curr_node_id);
+    const int text_end = prunes_diagonals(curr_node_id) ? (int)curr_node.sequence.size() : _end_offset;
+    for (Cell::pos_t idx = lane.m_range.start; idx < lane.m_range.end; ++idx) {
+      int j = lane.m_wf->diag(idx) + lane.m_wf->offset(idx);
+      LCP(curr_node, lane.m_wf->offset(idx), j, text_end);
+    }
+  }
+}
+
+
 void TheseusAlignerImpl::compute_new_wave() {
+  // The default penalties use the kernels specialized at compile time
+  if (_penalties->linear_gaps) {
+    compute_new_wave(_penalties->linear);
+  }
+  else if (_penalties->default_affine) {
+    compute_new_wave(DefaultAffineModel());
+  }
+  else {
+    compute_new_wave(_penalties->affine);
+  }
+}
+
+
+template <typename Model>
+void TheseusAlignerImpl::compute_new_wave(const Model &model) {
+  // The positions in the scope are given by the model
+  assert(_scope->size() == model.nscores());
+  if (_wave_pool) {
+    compute_new_wave_parallel(model);
+    return;
+  }
   // Update invalid segments
   _vertices_data->expand();
-  _vertices_data->compact();
-  // Process all active vertices
-  int num_active_vertices = _vertices_data->num_active_vertices();
-  NodeId curr_node_id;
-  for (int l = 0; l < num_active_vertices; ++l) {
-    curr_node_id = _vertices_data->get_vertex_id(l);
-    process_vertex(curr_node_id);
+  // Vertices not processed in this score keep empty ranges
+  _scope->reserve_ranges(_score, _vertices_data->num_active_vertices());
+  // The cells are stored directly in the wavefronts of the score
+  _lane.i_wf = &_scope->i_wf(model, _score);
+  _lane.d_wf = &_scope->d_wf(model, _score);
+  _lane.m_wf = &_beyond_scope->m_wf();
+  // Process only the vertices with data in the scope (vertices revived during
+  // this score are processed from the next one)
+  const std::vector<int> &live_vertices = _vertices_data->live_vertices();
+  const size_t num_live_vertices = live_vertices.size();
+  for (size_t l = 0; l < num_live_vertices; ++l) {
+    process_vertex(model, _vertices_data->get_vertex_id(live_vertices[l]));
   }
   _beyond_scope->update_positions();
 }
 
 
+// Append the cells in range of a lane wavefront to a wavefront of the score
+static Scope::range append_cells(Cell::CellVector &wf, const Cell::CellVector &lane_wf, Scope::range range) {
+  Scope::range new_range;
+  new_range.start = wf.size();
+  for (Cell::pos_t idx = range.start; idx < range.end; ++idx) {
+    wf.push_back(lane_wf[idx]);
+  }
+  new_range.end = wf.size();
+  return new_range;
+}
+
+
+template <typename Model>
+void TheseusAlignerImpl::compute_new_wave_parallel(const Model &model) {
+  // Update invalid segments
+  _vertices_data->expand();
+  // Vertices not processed in this score keep empty ranges
+  _scope->reserve_ranges(_score, _vertices_data->num_active_vertices());
+  const std::vector<int> &live_vertices = _vertices_data->live_vertices();
+  const size_t num_live_vertices = live_vertices.size();
+  for (auto &lane : _wave_lanes) {
+    lane.own_i_wf.clear();
+    lane.own_d_wf.clear();
+    lane.own_m_wf.clear();
+    lane.max_offset = 0;
+  }
+  // Next (and extend within the vertex) of each vertex, on any thread
+  _lane_cells.resize(num_live_vertices);
+  const WavePool::Task compute = [&](int l, size_t v) {
+    WaveLane &lane = _wave_lanes[l];
+    compute_vertex(model, lane, _vertices_data->get_vertex_id(live_vertices[v]));
+    _lane_cells[v] = LaneCells{l, lane.i_range, lane.d_range, lane.m_range};
+  };
+  // Waking the threads up is only worth it for wide waves
+  constexpr size_t min_vertices_per_thread = 4;
+  if (num_live_vertices >= min_vertices_per_thread * _wave_pool->size()) {
+    _wave_pool->run(num_live_vertices, compute);
+  }
+  else {
+    for (size_t v = 0; v < num_live_vertices; ++v) {
+      compute(0, v);
+    }
+  }
+  for (const auto &lane : _wave_lanes) {
+    _heuristics.update_max_offset(lane.max_offset);
+  }
+  // Merge the cells and follow the jumps in the order of the vertices
+  for (size_t v = 0; v < num_live_vertices; ++v) {
+    const int v_pos = live_vertices[v];
+    const NodeId curr_node_id = _vertices_data->get_vertex_id(v_pos);
+    const LaneCells &cells = _lane_cells[v];
+    const WaveLane &lane = _wave_lanes[cells.lane];
+    const Scope::range i_range = append_cells(_scope->i_wf(model, _score), lane.own_i_wf, cells.i_range);
+    const Scope::range d_range = append_cells(_scope->d_wf(model, _score), lane.own_d_wf, cells.d_range);
+    const Scope::range m_range = append_cells(_beyond_scope->m_wf(), lane.own_m_wf, cells.m_range);
+    _scope->set_ranges(_score, v_pos, i_range, d_range, m_range);
+    // Keep the vertex live while it stores cells
+    if (i_range.end > i_range.start || d_range.end > d_range.start || m_range.end > m_range.start) {
+      _vertices_data->mark_live(v_pos, _score);
+    }
+    // Jumps of the I cells
+    if (i_range.end > i_range.start && has_out_nodes(curr_node_id)) {
+      check_and_store_jumps(get_node(curr_node_id), _scope->i_wf(model, _score), i_range);
+    }
+    // Extend (the cells are already extended within the vertex)
+    for (Cell::pos_t idx = m_range.start; idx < m_range.end; ++idx) {
+      extend_diagonal(curr_node_id, idx, Cell::Matrix::M);
+    }
+  }
+  _beyond_scope->update_positions();
+}
+
+
+bool TheseusAlignerImpl::prunes_cell(WaveLane &lane, int offset) {
+  if (!lane.concurrent) {
+    return _heuristics.check_local_heuristics(offset);
+  }
+  lane.max_offset = std::max(lane.max_offset, offset);
+  return _heuristics.check_local_heuristics_const(offset);
+}
+
+
+void TheseusAlignerImpl::run_alignment(
+    std::string_view seq,
+    bool reverse_alignment,
+    bool density_drop_active,
+    bool lag_pruning_active)
+{
+  // Initialize data for the new alignment
+  if (_graph.is_packed()) {
+    // Pack the query as well so that the LCP can compare whole words
+    _packed_seq.assign(seq);
+    new_alignment(Graph::SequenceView(&_packed_seq, reverse_alignment), reverse_alignment, density_drop_active, lag_pruning_active);
+  }
+  else {
+    new_alignment(Graph::SequenceView(seq, reverse_alignment), reverse_alignment, density_drop_active, lag_pruning_active);
+  }
+  _score = 0;
+  // _graph.print_code_graphviz();
+  // Main alignment loop
+  while (_alignment.theseus_status == THESEUS_STATUS_OK && _score <= _max_score) {
+    // Initial extend
+    if (_score == 0) {
+      extend_diagonal(_start_node, 0, Cell::Matrix::MJumps);
+    }
+    // Next wave + extend
+    compute_new_wave();
+    // Bidirectional mode: stop as soon as the reverse half meets the forward one
+    if (_search_breakpoint && check_breakpoint()) {
+      _max_score = _score;
+    }
+    // Checkpoint mode: keep the M cells of the scope every few scores
+    if (_checkpointing && _score % _checkpoint_interval == 0) {
+      store_checkpoint();
+    }
+    // Without backtrace, only the cells in the scope of the next score are needed
+    if (_score_only || _checkpointing) {
+      _beyond_scope->discard_scores_before(_score + 1 - _scope->size());
+    }
+    // Evaluate global heuristics
+    _alignment.theseus_status = (_alignment.theseus_status == THESEUS_STATUS_ALG_COMPLETED) ?
+                                 _alignment.theseus_status :
+                                  _heuristics.check_global_heuristics(_score);
+    // Budgets of the alignment
+    if (_budgets_active && _alignment.theseus_status == THESEUS_STATUS_OK) {
+      _alignment.theseus_status = _heuristics.is_over_step_limit(
+          _score, _scope->num_cells() + _beyond_scope->num_cells());
+    }
+    // Extension mode: stop when the furthest cell falls too far behind the best extension
+    if (_xdrop_active) {
+      check_xdrop();
+    }
+    // Update score
+    _score = _score + 1;
+    // Clear the corresponding waves and metadata from the scope
+    _scope->new_score(_score);
+    _vertices_data->new_score(_score);
+  }
+  _score -= 1;
+}
+
+
 Alignment TheseusAlignerImpl::align(
     std::string_view seq,
     // Seq-to-graph parameters
@@ -158,7 +363,7 @@ Alignment TheseusAlignerImpl::align(
     int  start_offset,
     // MSA parameters
     int  weight,
-    bool is_ends_free,
+    EndsFree ends_free,
     // Common parameters
     bool reverse_alignment,
     bool density_drop_active,
@@ -166,6 +371,31 @@ Alignment TheseusAlignerImpl::align(
     bool add_to_graph
   )
 {
+  Alignment alignment;
+  align_into(alignment, seq, start_node, start_offset, weight, ends_free,
+             reverse_alignment, density_drop_active, lag_pruning_active, add_to_graph);
+  return alignment;
+}
+
+
+void TheseusAlignerImpl::align_into(
+    Alignment &alignment,
+    std::string_view seq,
+    // Seq-to-graph parameters
+    int  start_node,
+    int  start_offset,
+    // MSA parameters
+    int  weight,
+    EndsFree ends_free,
+    // Common parameters
+    bool reverse_alignment,
+    bool density_drop_active,
+    bool lag_pruning_active,
+    bool add_to_graph
+  )
+{
+  // Work on the buffers of the caller (the alignment is swapped back at the end)
+  std::swap(_alignment, alignment);
   // MSA_mode: Start position depends on the alignment direction)
   if (_is_msa) {
     if (!reverse_alignment) {
@@ -185,38 +415,52 @@ Alignment TheseusAlignerImpl::align(
     _start_offset = start_offset;
   }
   // Set alignment parameters
-  _ends_free = is_ends_free;
-  // Initialize data for the new alignment
-  new_alignment(Graph::SequenceView(seq, reverse_alignment), reverse_alignment, density_drop_active, lag_pruning_active);
-  _score = 0;
-  // _graph.print_code_graphviz();
-  // Main alignment loop
-  while (_alignment.theseus_status == THESEUS_STATUS_OK) {
-    // Initial extend
-    if (_score == 0) {
-      extend_diagonal(_start_node, 0, Cell::Matrix::MJumps);
+  _ends_free = _is_msa ? EndsFree{} : ends_free;
+  // Compute the wavefronts (in checkpoint mode, only those of the checkpoints are kept)
+  _checkpointing = _checkpoint_interval > 0 && !_score_only && !reverse_alignment;
+  _checkpoint_cells.clear();
+  _checkpoint_starts.clear();
+  _checkpoint_scores.clear();
+  _budgets_active = _heuristics.is_steps_limit_active();
+  _xdrop_active = _heuristics.is_xdrop_active() && !_is_msa;
+  _adaptive_active = _heuristics.is_adaptive_reduction_active();
+  run_alignment(seq, reverse_alignment, density_drop_active, lag_pruning_active);
+  const bool partial_backtrace =
+      _alignment.theseus_status == THESEUS_STATUS_END_UNREACHABLE ||
+      _alignment.theseus_status == THESEUS_STATUS_ALG_PARTIAL ||
+      (_alignment.theseus_status == THESEUS_STATUS_MAX_STEPS_REACHED && _heuristics.partial_alignment_on_limit());
+  bool traced = false;
+  if (_checkpointing) {
+    _checkpointing = false;
+    _budgets_active = false;
+    const bool xdrop_active = _xdrop_active;
+    _xdrop_active = false;
+    _adaptive_active = false;
+    traced = (_alignment.theseus_status == THESEUS_STATUS_ALG_COMPLETED) && checkpoint_backtrace(seq);
+    if (!traced && (_alignment.theseus_status == THESEUS_STATUS_ALG_COMPLETED || partial_backtrace)) {
+      // Recompute the alignment keeping all the cells
+      _budgets_active = _heuristics.is_steps_limit_active();
+      _xdrop_active = xdrop_active;
+      _adaptive_active = _heuristics.is_adaptive_reduction_active();
+      run_alignment(seq, reverse_alignment, density_drop_active, lag_pruning_active);
     }
-    // Next wave + extend
-    compute_new_wave();
-    // Evaluate global heuristics
-    _alignment.theseus_status = (_alignment.theseus_status == THESEUS_STATUS_ALG_COMPLETED) ?
-                                 _alignment.theseus_status :
-                                  _heuristics.check_global_heuristics(_score);
-    // Update score
-    _score = _score + 1;
-    // Clear the corresponding waves and metadata from the scope
-    _scope->new_score(_score);
-    _vertices_data->new_score(_score);
   }
-  _score -= 1;
+  _budgets_active = false;
+  _xdrop_active = false;
+  _adaptive_active = false;
   // Backtrace
-  if (_alignment.theseus_status == THESEUS_STATUS_ALG_COMPLETED) {
-    backtrace();
+  if (_score_only) {
+    // Nothing to do
+  }
+  else if (_alignment.theseus_status == THESEUS_STATUS_ALG_COMPLETED) {
+    if (!traced) {
+      backtrace();
+    }
     if (_is_msa && add_to_graph) {
       _seq_ID += 1;
       // Compute the end column of the alignment in the POA graph
       int end_column = _start_pos.offset + _start_pos.diag;
-      _poa_graph->add_alignment_poa(_graph, _alignment, _seq, _seq_ID, weight, end_column);
+      _poa_graph->add_alignment_poa(*_msa_graph, _alignment, _seq, _seq_ID, weight, end_column);
     }
   }
   else {
@@ -224,48 +468,477 @@ Alignment TheseusAlignerImpl::align(
     if (_alignment.theseus_status == THESEUS_STATUS_END_UNREACHABLE) {
       // Choose starting position for backtrace (cell with maximum offset in M[s-_s_min]-M[s-_s_min - scope_size])
       // matrix on the last scope scores
-      init_partial_backtrace();
+      init_partial_backtrace(_heuristics.s_min());
       // Perform partial backtrace
       backtrace();
       // No drop in MSA mode
     }
+    else if (_alignment.theseus_status == THESEUS_STATUS_MAX_STEPS_REACHED &&
+             _heuristics.partial_alignment_on_limit()) {
+      // Backtrace from the furthest cell of the last scores
+      init_partial_backtrace(0);
+      backtrace();
+    }
+    else if (_alignment.theseus_status == THESEUS_STATUS_ALG_PARTIAL) {
+      // Backtrace from the cell of the best extension
+      _start_pos = _xdrop_best_cell;
+      backtrace();
+    }
   }
-  return _alignment;
+  _alignment.query_length = seq.size();
+  std::swap(_alignment, alignment);
 }
 
+
+AlignmentScore TheseusAlignerImpl::align_score(
+    std::string_view seq,
+    int  start_node,
+    int  start_offset,
+    bool reverse_alignment,
+    bool density_drop_active,
+    bool lag_pruning_active,
+    EndsFree ends_free
+  )
+{
+  _score_only = true;
+  Alignment alignment;
+  align_into(alignment, seq, start_node, start_offset, 1, ends_free,
+             reverse_alignment, density_drop_active, lag_pruning_active, false);
+  _score_only = false;
+
+  AlignmentScore result;
+  result.theseus_status = alignment.theseus_status;
+  result.score = _score;
+  if (alignment.theseus_status == THESEUS_STATUS_ALG_COMPLETED) {
+    result.end_node = _start_pos.vertex_id;
+    result.end_offset = _start_pos.diag + _start_pos.offset; // Vertex offset = j
+    result.query_end = _start_pos.offset;
+  }
+  else if (alignment.theseus_status == THESEUS_STATUS_ALG_PARTIAL) {
+    result.score = _heuristics.best_extension_score();
+    result.end_node = _xdrop_best_cell.vertex_id;
+    result.end_offset = _xdrop_best_cell.diag + _xdrop_best_cell.offset;
+    result.query_end = _xdrop_best_cell.offset;
+  }
+  return result;
+}
+
+void TheseusAlignerImpl::set_heuristics(const Heuristics &heuristics)
+{
+  _heuristics = heuristics;
+}
+
+void TheseusAlignerImpl::set_parallel_wave(int num_threads)
+{
+  if (num_threads <= 1) {
+    _wave_pool.reset();
+    _wave_lanes.clear();
+    return;
+  }
+  _wave_pool = std::make_unique<WavePool>(num_threads);
+  _wave_lanes = std::vector<WaveLane>(num_threads);
+  for (auto &lane : _wave_lanes) {
+    lane.concurrent = true;
+    for (Cell::CellVector *wf : {&lane.own_i_wf, &lane.own_d_wf, &lane.own_m_wf}) {
+      wf->set_realloc_policy([](Cell::CellVector::size_type, Cell::CellVector::size_type required_size) {
+        return 2 * required_size;
+      });
+    }
+    lane.i_wf = &lane.own_i_wf;
+    lane.d_wf = &lane.own_d_wf;
+    lane.m_wf = &lane.own_m_wf;
+  }
+}
+
+
+void TheseusAlignerImpl::set_checkpoint_interval(int interval)
+{
+  _checkpoint_interval = std::max(0, interval);
+}
+
+void TheseusAlignerImpl::align_bidirectional_into(
+    Alignment &alignment,
+    std::string_view seq,
+    int  start_node,
+    int  start_offset,
+    int  weight,
+    bool add_to_graph
+  )
+{
+  if (_is_msa) {
+    start_node = 0;
+    start_offset = 0;
+  }
+  // The score-only pass gives the end of the alignment and its score
+  AlignmentScore score = align_score(seq, start_node, start_offset);
+  int final_score = -1;
+  if (score.theseus_status == THESEUS_STATUS_ALG_COMPLETED) {
+    _bidirectional_alignment.path.clear();
+    _bidirectional_alignment.cigar.clear();
+    final_score = align_segment(seq, start_node, start_offset, score.end_node, score.end_offset, score.score);
+  }
+  // Only happens if the end is not reachable: align as usual
+  if (final_score != score.score) {
+    align_into(alignment, seq, start_node, start_offset, weight, EndsFree{},
+               false, false, false, add_to_graph);
+    return;
+  }
+  alignment.theseus_status = THESEUS_STATUS_ALG_COMPLETED;
+  alignment.start_offset = start_offset;
+  alignment.end_offset = score.end_offset;
+  alignment.query_length = seq.size();
+  alignment.query_end = score.query_end;
+  alignment.path.assign(_bidirectional_alignment.path.begin(), _bidirectional_alignment.path.end());
+  alignment.cigar.clear();
+  for (const CigarRun &run : _bidirectional_alignment.cigar) {
+    alignment.add_ops(run.op, run.length);    // Merge the runs split between segments
+  }
+  // Leave the aligner as after a regular alignment of the whole sequence
+  _seq = SequenceView(seq, false);
+  _start_node = start_node;
+  _start_offset = start_offset;
+  _score = final_score;
+  if (_is_msa && add_to_graph) {
+    _seq_ID += 1;
+    _poa_graph->add_alignment_poa(*_msa_graph, alignment, _seq, _seq_ID, weight, alignment.end_offset);
+  }
+}
+
+
+int TheseusAlignerImpl::align_segment(
+    std::string_view seq,
+    NodeId start_node,
+    int    start_column,
+    NodeId end_node,
+    int    end_column,
+    int    score)
+{
+  // Cheap segments are aligned directly
+  const int window = _scope->size() - 1;
+  if (score > std::max(bidirectional_base_score, 4 * window) &&
+      find_breakpoint(seq, start_node, start_column, end_node, end_column, score)) {
+    const Breakpoint breakpoint = _breakpoint;
+    const size_t nruns = _bidirectional_alignment.cigar.size();
+    const size_t npath = _bidirectional_alignment.path.size();
+    const int prefix_score = align_segment(seq.substr(0, breakpoint.offset), start_node, start_column,
+                                           breakpoint.vertex_id, breakpoint.column, breakpoint.prefix_score);
+    const int suffix_score = (prefix_score < 0) ? -1 :
+                             align_segment(seq.substr(breakpoint.offset), breakpoint.vertex_id, breakpoint.column,
+                                           end_node, end_column, breakpoint.suffix_score);
+    if (prefix_score >= 0 && suffix_score >= 0 && prefix_score + suffix_score <= score) {
+      return prefix_score + suffix_score;
+    }
+    // The halves are not optimal: discard them and align the whole segment
+    _bidirectional_alignment.cigar.resize(nruns);
+    _bidirectional_alignment.path.resize(npath);
+  }
+  return align_segment_directly(seq, start_node, start_column, end_node, end_column, score);
+}
+
+
+int TheseusAlignerImpl::align_segment_directly(
+    std::string_view seq,
+    NodeId start_node,
+    int    start_column,
+    NodeId end_node,
+    int    end_column,
+    int    score)
+{
+  // Align the segment keeping all the cells
+  _start_node = start_node;
+  _start_offset = start_column;
+  _fixed_end = true;
+  _end_node = end_node;
+  _end_offset = end_column;
+  _max_score = score;
+  run_alignment(seq, false, false, false);
+  _fixed_end = false;
+  _max_score = std::numeric_limits<int>::max();
+  if (_alignment.theseus_status != THESEUS_STATUS_ALG_COMPLETED) {
+    return -1;
+  }
+  backtrace();
+  // Append it to the previous segments, which end at the first vertex of this one
+  _bidirectional_alignment.cigar.insert(_bidirectional_alignment.cigar.end(),
+                                        _alignment.cigar.begin(), _alignment.cigar.end());
+  auto first_vertex = _alignment.path.begin();
+  if (!_bidirectional_alignment.path.empty()) ++first_vertex;
+  _bidirectional_alignment.path.insert(_bidirectional_alignment.path.end(), first_vertex, _alignment.path.end());
+  return _score;
+}
+
+
+bool TheseusAlignerImpl::find_breakpoint(
+    std::string_view seq,
+    NodeId start_node,
+    int    start_column,
+    NodeId end_node,
+    int    end_column,
+    int    score)
+{
+  const int window = _scope->size() - 1;
+  const int half_score = score / 2;
+  _score_only = true;
+  _fixed_end = true;
+  // Forward half: compute the wavefronts up to half the score
+  _start_node = start_node;
+  _start_offset = start_column;
+  _end_node = end_node;
+  _end_offset = end_column;
+  _max_score = half_score;
+  run_alignment(seq, false, false, false);
+  // Keep the M cells of the last scores (the others have been released)
+  _meeting_cells.clear();
+  if (_alignment.theseus_status == THESEUS_STATUS_OK) {
+    for (int s = half_score - window + 1; s <= half_score; ++s) {
+      for (int pos = _beyond_scope->m_wf_pos(s - 1); pos < _beyond_scope->m_wf_pos(s); ++pos) {
+        const Cell cell = _beyond_scope->m_wf()[pos];
+        _meeting_cells.push_back(MeetingCell{cell.vertex_id, cell.diag, cell.offset, s});
+      }
+      for (int pos = _beyond_scope->m_jumps_wf_pos(s - 1); pos < _beyond_scope->m_jumps_wf_pos(s); ++pos) {
+        const Cell cell = _beyond_scope->m_jumps_wf()[pos];
+        _meeting_cells.push_back(MeetingCell{cell.vertex_id, cell.diag, cell.offset, s});
+      }
+    }
+    std::sort(_meeting_cells.begin(), _meeting_cells.end());
+  }
+  _score_only = false;
+  _fixed_end = false;
+  _max_score = std::numeric_limits<int>::max();
+  // Reverse half: compute the wavefronts from the end until they meet the forward ones
+  return search_breakpoint(seq, start_node, start_column, end_node, end_column,
+                           score, score - half_score + window);
+}
+
+
+bool TheseusAlignerImpl::search_breakpoint(
+    std::string_view seq,
+    NodeId start_node,
+    int    start_column,
+    NodeId end_node,
+    int    end_column,
+    int    score,
+    int    max_reverse_score)
+{
+  _breakpoint_found = false;
+  if (_meeting_cells.empty()) {
+    return false;
+  }
+  _score_only = true;
+  _fixed_end = true;
+  _start_node = end_node;
+  _start_offset = _graph.node_size(end_node) - end_column;
+  _end_node = start_node;
+  _end_offset = _graph.node_size(start_node) - start_column;
+  _max_score = max_reverse_score;
+  _breakpoint_score = score;
+  _search_breakpoint = true;
+  run_alignment(seq, true, false, false);
+  _search_breakpoint = false;
+  _score_only = false;
+  _fixed_end = false;
+  _max_score = std::numeric_limits<int>::max();
+  return _breakpoint_found;
+}
+
+
+void TheseusAlignerImpl::store_checkpoint()
+{
+  const int window = _scope->size() - 1;
+  _checkpoint_starts.push_back(_checkpoint_cells.size());
+  _checkpoint_scores.push_back(_score);
+  for (int s = std::max(0, _score - window + 1); s <= _score; ++s) {
+    const int start_m = (s == 0) ? 0 : _beyond_scope->m_wf_pos(s - 1);
+    for (int pos = start_m; pos < _beyond_scope->m_wf_pos(s); ++pos) {
+      const Cell cell = _beyond_scope->m_wf()[pos];
+      _checkpoint_cells.push_back(MeetingCell{cell.vertex_id, cell.diag, cell.offset, s});
+    }
+    const int start_m_jumps = (s == 0) ? 0 : _beyond_scope->m_jumps_wf_pos(s - 1);
+    for (int pos = start_m_jumps; pos < _beyond_scope->m_jumps_wf_pos(s); ++pos) {
+      const Cell cell = _beyond_scope->m_jumps_wf()[pos];
+      _checkpoint_cells.push_back(MeetingCell{cell.vertex_id, cell.diag, cell.offset, s});
+    }
+  }
+  std::sort(_checkpoint_cells.begin() + _checkpoint_starts.back(), _checkpoint_cells.end());
+}
+
+
+bool TheseusAlignerImpl::checkpoint_backtrace(std::string_view seq)
+{
+  const Cell end_cell = _start_pos;
+  const NodeId start_node = _start_node;
+  const int start_offset = _start_offset;
+  const int score = _score;
+  const int window = _scope->size() - 1;
+  // Split the alignment at the checkpoints, from the end to the start
+  Breakpoint last{static_cast<NodeId>(end_cell.vertex_id), end_cell.diag + end_cell.offset,
+                  end_cell.offset, score, 0};
+  _checkpoint_breakpoints.clear();
+  for (int c = static_cast<int>(_checkpoint_scores.size()) - 1; c >= 0; --c) {
+    if (_checkpoint_scores[c] >= last.prefix_score) {
+      continue;
+    }
+    const size_t end_cells = (c + 1 < static_cast<int>(_checkpoint_starts.size())) ?
+                             _checkpoint_starts[c + 1] : _checkpoint_cells.size();
+    _meeting_cells.assign(_checkpoint_cells.begin() + _checkpoint_starts[c],
+                          _checkpoint_cells.begin() + end_cells);
+    // If the path does not go through the checkpoint, the segment spans the previous one too
+    if (search_breakpoint(seq.substr(0, last.offset), start_node, start_offset,
+                          last.vertex_id, last.column, last.prefix_score,
+                          last.prefix_score - _checkpoint_scores[c] + window)) {
+      last = _breakpoint;
+      _checkpoint_breakpoints.push_back(last);
+    }
+  }
+  // Recompute each segment keeping its cells, from the start to the end
+  _bidirectional_alignment.path.clear();
+  _bidirectional_alignment.cigar.clear();
+  NodeId segment_node = start_node;
+  int segment_column = start_offset;
+  int segment_offset = 0;
+  int segment_prefix_score = 0;
+  int total_score = 0;
+  bool completed = true;
+  for (size_t l = _checkpoint_breakpoints.size() + 1; l-- > 0;) {
+    const Breakpoint segment_end = (l == 0) ? Breakpoint{static_cast<NodeId>(end_cell.vertex_id),
+                                                         end_cell.diag + end_cell.offset,
+                                                         end_cell.offset, score, 0} :
+                                   _checkpoint_breakpoints[l - 1];
+    const int segment_score = align_segment_directly(
+        seq.substr(segment_offset, segment_end.offset - segment_offset), segment_node, segment_column,
+        segment_end.vertex_id, segment_end.column, segment_end.prefix_score - segment_prefix_score);
+    if (segment_score < 0) {
+      completed = false;
+      break;
+    }
+    total_score += segment_score;
+    segment_node = segment_end.vertex_id;
+    segment_column = segment_end.column;
+    segment_offset = segment_end.offset;
+    segment_prefix_score = segment_end.prefix_score;
+  }
+  _start_node = start_node;
+  _start_offset = start_offset;
+  if (!completed || total_score > score) {
+    return false;
+  }
+  // Leave the aligner as after a regular alignment of the whole sequence
+  _alignment.theseus_status = THESEUS_STATUS_ALG_COMPLETED;
+  _alignment.start_offset = start_offset;
+  _alignment.end_offset = end_cell.diag + end_cell.offset;
+  _alignment.query_end = end_cell.offset;
+  _alignment.path.assign(_bidirectional_alignment.path.begin(), _bidirectional_alignment.path.end());
+  _alignment.cigar.clear();
+  for (const CigarRun &run : _bidirectional_alignment.cigar) {
+    _alignment.add_ops(run.op, run.length);   // Merge the runs split between segments
+  }
+  _seq = SequenceView(seq, false);
+  _start_pos = end_cell;
+  _score = score;
+  return true;
+}
+
+
+bool TheseusAlignerImpl::check_breakpoint()
+{
+  // Cells of the reverse half with the current score
+  const int seq_size = _seq.size();
+  const int max_forward_score = _breakpoint_score - _score;
+  auto check_cells = [&](const Cell::CellVector &wf, int start_pos, int end_pos) {
+    for (int pos = start_pos; pos < end_pos; ++pos) {
+      const Cell cell = wf[pos];
+      // Forward diagonal in the same vertex: j_f - i_f with j_f = |v| - j_r and i_f = |q| - i_r
+      const int forward_diag = _graph.node_size(cell.vertex_id) - seq_size - cell.diag;
+      const MeetingCell key{static_cast<NodeId>(cell.vertex_id), forward_diag, 0, 0};
+      auto it = std::lower_bound(_meeting_cells.begin(), _meeting_cells.end(), key,
+                                 [](const MeetingCell &a, const MeetingCell &b) {
+                                   return std::tie(a.vertex_id, a.diag) < std::tie(b.vertex_id, b.diag);
+                                 });
+      for (; it != _meeting_cells.end() && it->vertex_id == key.vertex_id && it->diag == forward_diag; ++it) {
+        // The diagonals overlap: the reverse path can be preceded by the
+        // forward one (the score does not decrease along a diagonal)
+        if (it->offset + cell.offset >= seq_size && it->score <= max_forward_score) {
+          _breakpoint.vertex_id = cell.vertex_id;
+          _breakpoint.offset = seq_size - cell.offset;
+          _breakpoint.column = forward_diag + _breakpoint.offset;
+          _breakpoint.prefix_score = it->score;
+          _breakpoint.suffix_score = _score;
+          _breakpoint_found = true;
+          return true;
+        }
+      }
+    }
+    return false;
+  };
+  return check_cells(_beyond_scope->m_wf(), (_score == 0) ? 0 : _beyond_scope->m_wf_pos(_score - 1),
+                     _beyond_scope->m_wf_pos(_score)) ||
+         check_cells(_beyond_scope->m_jumps_wf(), (_score == 0) ? 0 : _beyond_scope->m_jumps_wf_pos(_score - 1),
+                     _beyond_scope->m_jumps_wf_pos(_score));
+}
+
+  // Filter pass of the sparsify kernels
+  template <typename PosAt>
+  Cell::pos_t TheseusAlignerImpl::filter_sparsify_candidates(WaveLane & lane,
+                                                             const Cell::CellVector & dense_wf,
+                                                             Cell::pos_t len,
+                                                             PosAt pos_at,
+                                                             int offset_increase,
+                                                             int shift_factor,
+                                                             int m,
+                                                             int upper_bound)
+  {
+    if (lane.sparsify_candidates.capacity() < len) {
+      lane.sparsify_candidates.realloc(len);
+    }
+    Cell::pos_t *candidates = lane.sparsify_candidates.data();
+    // Raw columns start at the first cell kept by the wavefront
+    const Cell::idx2d_t *offsets = dense_wf.offsets();
+    const Cell::idx2d_t *diags = dense_wf.diags();
+    const Cell::pos_t origin = dense_wf.origin();
+    Cell::pos_t ncandidates = 0;
+    // Only the offset and diagonal columns are read, and the candidate is always
+    // written: the loop has no data-dependent branches
+    for (Cell::pos_t l = 0; l < len; ++l)
+    {
+      const Cell::pos_t pos = pos_at(l);
+      const int new_offset = offsets[pos - origin] + offset_increase;
+      const int new_col = new_offset + diags[pos - origin] + shift_factor; // d = j - i -> j = d + i
+      candidates[ncandidates] = pos;
+      ncandidates += (new_offset <= m) & (new_col <= upper_bound);
+    }
+    return ncandidates;
+  }
+
   // Sparsify M data
-  void TheseusAlignerImpl::sparsify_M_data(Cell::CellVector & dense_wf,
+  void TheseusAlignerImpl::sparsify_M_data(WaveLane & lane,
+                                           Cell::CellVector & dense_wf,
                                            int offset_increase,
                                            int shift_factor,
                                            Scope::range cells_range,
                                            int m,
                                            int upper_bound)
   {
-    Cell::pos_t len = cells_range.end - cells_range.start, new_col;
+    // Filter the diagonals that stay in bounds
+    Cell::pos_t ncandidates = filter_sparsify_candidates(lane, dense_wf, cells_range.end - cells_range.start,
+      [start = cells_range.start](Cell::pos_t l) { return start + l; },
+      offset_increase, shift_factor, m, upper_bound);
+    // Merge them into the scratchpad
     Cell new_cell;
-    // Sparsify the active diagonals
-    for (int l = 0; l < len; ++l)
+    for (Cell::pos_t l = 0; l < ncandidates; ++l)
     {
-      new_cell = dense_wf[cells_range.start + l];
+      const Cell::pos_t pos = lane.sparsify_candidates.data()[l];
+      new_cell = dense_wf[pos];
       new_cell.diag += shift_factor;
       new_cell.offset += offset_increase;
       new_cell.from_matrix = Cell::Matrix::M;
-      new_cell.prev_pos = cells_range.start + l;
-      new_col = new_cell.offset + new_cell.diag; // d = j - i -> j = d + i
-      // Check validity
-      if (new_cell.offset <= m && new_col <= upper_bound)
-      { // If in bounds
-        // Branchless push_back
-        auto &cell = _scratchpad->access_alloc(new_cell.diag);
-        // If better offset
-        const bool cmp = cell.offset < new_cell.offset;
-        cell = (cmp) ? new_cell : cell;
-      }
+      new_cell.prev_pos = pos;
+      lane.scratchpad->merge_max(new_cell);
     }
   }
 
   // Sparsify jumps data
-  void TheseusAlignerImpl::sparsify_jumps_data(Cell::CellVector & dense_wf,
+  void TheseusAlignerImpl::sparsify_jumps_data(WaveLane & lane,
+                                               Cell::CellVector & dense_wf,
                                                std::vector<Cell::pos_t> & jumps_positions,
                                                int offset_increase,
                                                int shift_factor,
@@ -273,192 +946,266 @@ Alignment TheseusAlignerImpl::align(
                                                int upper_bound,
                                                Cell::Matrix from_matrix)
   {
-    int len = jumps_positions.size(), new_col, pos;
+    // Filter the diagonals that stay in bounds
+    Cell::pos_t ncandidates = filter_sparsify_candidates(lane, dense_wf, jumps_positions.size(),
+      [positions = jumps_positions.data()](Cell::pos_t l) { return positions[l]; },
+      offset_increase, shift_factor, m, upper_bound);
+    // Merge them into the scratchpad
     Cell new_cell;
-    // Sparsify the active diagonals
-    for (int l = 0; l < len; ++l)
+    for (Cell::pos_t l = 0; l < ncandidates; ++l)
     {
-      pos = jumps_positions[l];
+      const Cell::pos_t pos = lane.sparsify_candidates.data()[l];
       new_cell = dense_wf[pos];
       new_cell.prev_pos = pos;
       new_cell.from_matrix = from_matrix;
       new_cell.diag += shift_factor;
       new_cell.offset += offset_increase;
-      new_col = new_cell.offset + new_cell.diag; // d = j - i -> j = d + i
-      // Check validity
-      if (new_cell.offset <= m && new_col <= upper_bound)
-      { // If in bounds
-        // Branchless push_back
-        auto &cell = _scratchpad->access_alloc(new_cell.diag);
-        // If better offset
-        const bool cmp = cell.offset < new_cell.offset;
-        cell = (cmp) ? new_cell : cell;
-      }
+      lane.scratchpad->merge_max(new_cell);
     }
   }
 
   // Sparsify indel
-  void TheseusAlignerImpl::sparsify_indel_data(Cell::CellVector & dense_wf,
+  void TheseusAlignerImpl::sparsify_indel_data(WaveLane & lane,
+                                               Cell::CellVector & dense_wf,
                                                int offset_increase,
                                                int shift_factor,
                                                Scope::range cells_range,
                                                int m,
                                                int upper_bound)
   {
-    Cell::pos_t len = cells_range.end - cells_range.start, new_col;
+    // Filter the diagonals that stay in bounds
+    Cell::pos_t ncandidates = filter_sparsify_candidates(lane, dense_wf, cells_range.end - cells_range.start,
+      [start = cells_range.start](Cell::pos_t l) { return start + l; },
+      offset_increase, shift_factor, m, upper_bound);
+    // Merge them into the scratchpad
     Cell new_cell;
-    // Sparsify the active diagonals
-    for (int l = 0; l < len; ++l)
+    for (Cell::pos_t l = 0; l < ncandidates; ++l)
     {
       // Vertex_id and previous matrix are the same as before
-      new_cell = dense_wf[cells_range.start + l];
+      new_cell = dense_wf[lane.sparsify_candidates.data()[l]];
       new_cell.diag += shift_factor;
       new_cell.offset += offset_increase;
-      new_col = new_cell.offset + new_cell.diag; // d = j - i -> j = d + i
-      // Check validity
-      if (new_cell.offset <= m && new_col <= upper_bound)
-      { // If in bounds
-        // Branchless push_back
-        auto &cell = _scratchpad->access_alloc(new_cell.diag);
-        // If better offset
-        const bool cmp = cell.offset < new_cell.offset;
-        cell = (cmp) ? new_cell : cell;
-      }
+      lane.scratchpad->merge_max(new_cell);
     }
   }
 
   // Compute next I matrix
-  void TheseusAlignerImpl::next_I(int upper_bound,
+  template <typename Model>
+  void TheseusAlignerImpl::next_I(const Model &model,
+                                  WaveLane &lane,
+                                  int upper_bound,
                                   NodeId curr_node_id)
   {
     // Sparsify data (put it in the scratch pad)
-    int pos_prev_M = _score - (_internal_penalties.gapo() + _internal_penalties.gape()), pos_prev_I = _score - _internal_penalties.gape(), pos_prev_M_scope = _vertices_data->get_pos(pos_prev_M);
-    int pos_prev_I_scope = _vertices_data->get_pos(pos_prev_I);
+    int pos_prev_M = _score - (model.gapo() + model.gape()), pos_prev_I = _score - model.gape(), pos_prev_M_scope = model.scope_pos(pos_prev_M);
+    int pos_prev_I_scope = model.scope_pos(pos_prev_I);
     // Come from an Insertion
     if (pos_prev_I >= 0) {
-      if (_scope->i_pos(pos_prev_I).size() > _vertices_data->get_id(curr_node_id))
+      if (_scope->i_pos(model, pos_prev_I).size() > _vertices_data->get_id(curr_node_id))
       {
-        Scope::range cells_range = _scope->i_pos(pos_prev_I)[_vertices_data->get_id(curr_node_id)];
-        sparsify_indel_data(_scope->i_wf(pos_prev_I), 0, 1, cells_range, _seq.size(), upper_bound); // Sparsify I data
+        Scope::range cells_range = _scope->i_pos(model, pos_prev_I)[_vertices_data->get_id(curr_node_id)];
+        sparsify_indel_data(lane, _scope->i_wf(model, pos_prev_I), 0, 1, cells_range, _seq.size(), upper_bound); // Sparsify I data
       };
       sparsify_jumps_data(
-        _beyond_scope->i_jumps_wf(),
+        lane, _beyond_scope->i_jumps_wf(),
         _vertices_data->get_vertex_data(curr_node_id)._i_jumps_positions[pos_prev_I_scope],
         0, 1, _seq.size(), upper_bound, Cell::Matrix::IJumps);
     }
     // Come from M
     if (pos_prev_M >= 0) {
-      if (_scope->m_pos(pos_prev_M).size() > _vertices_data->get_id(curr_node_id)) {
-        Scope::range cells_range = _scope->m_pos(pos_prev_M)[_vertices_data->get_id(curr_node_id)];
-        sparsify_M_data(_beyond_scope->m_wf(), 0, 1, cells_range, _seq.size(), upper_bound); // Sparsify M data
+      if (_scope->m_pos(model, pos_prev_M).size() > _vertices_data->get_id(curr_node_id)) {
+        Scope::range cells_range = _scope->m_pos(model, pos_prev_M)[_vertices_data->get_id(curr_node_id)];
+        sparsify_M_data(lane, _beyond_scope->m_wf(), 0, 1, cells_range, _seq.size(), upper_bound); // Sparsify M data
       }
-      sparsify_jumps_data(_beyond_scope->m_jumps_wf(),
+      sparsify_jumps_data(lane, _beyond_scope->m_jumps_wf(),
           _vertices_data->get_vertex_data(curr_node_id)._m_jumps_positions[pos_prev_M_scope],
           0, 1, _seq.size(), upper_bound, Cell::Matrix::MJumps);
     }
     // Densify data (store it in the big wavefront)
     Scope::range new_range;
-    new_range.start = _scope->i_wf(_score).size();
-    for (auto diag : _scratchpad->active_diags()) {
-      if (_vertices_data->valid_diagonal<Cell::Matrix::I>(curr_node_id, diag)
-      && !_heuristics.check_local_heuristics((*_scratchpad)[diag].offset)) {
-        _scope->i_wf(_score).push_back((*_scratchpad)[diag]);     // Store Cell
+    new_range.start = lane.i_wf->size();
+    auto active_diags = lane.scratchpad->active_diags();
+    lane.valid_diags.resize(active_diags.size());
+    if (prunes_diagonals(curr_node_id)) {
+      _vertices_data->valid_diagonals<Cell::Matrix::I>(curr_node_id, active_diags, lane.valid_diags.data(),
+                                                                lane.band_validity);
+    }
+    else {
+      std::fill(lane.valid_diags.begin(), lane.valid_diags.end(), 1);
+    }
+    for (size_t l = 0; l < active_diags.size(); ++l) {
+      const auto diag = active_diags[l];
+      if (lane.valid_diags[l] && !prunes_cell(lane, (*lane.scratchpad)[diag].offset)) {
+        lane.i_wf->push_back((*lane.scratchpad)[diag]);     // Store Cell
       }
     }
-    new_range.end = _scope->i_wf(_score).size();
-    _scope->i_pos(_score).push_back(new_range);
-    // Check, store and invalidate new I jumps
-    if (has_out_nodes(curr_node_id)) {
+    new_range.end = lane.i_wf->size();
+    lane.i_range = new_range;
+    // Check, store and invalidate new I jumps (in the parallel wave, when the cells are merged)
+    if (!lane.concurrent && has_out_nodes(curr_node_id)) {
       NodeView curr_node = get_node(curr_node_id);
-      check_and_store_jumps(curr_node, _scope->i_wf(_score), new_range);
+      check_and_store_jumps(curr_node, *lane.i_wf, new_range);
     }
 }
 
 
 // Compute next D matrix
-void TheseusAlignerImpl::next_D(int upper_bound,
+template <typename Model>
+void TheseusAlignerImpl::next_D(const Model &model,
+                                WaveLane &lane,
+                                int upper_bound,
                                 NodeId curr_node_id)
 {
   // Sparsify data (put it in the scratch pad)
-  int pos_prev_M = _score - (_internal_penalties.gapo() + _internal_penalties.gape()),
-      pos_prev_D = _score - _internal_penalties.gape(),
-      pos_prev_M_scope = _vertices_data->get_pos(pos_prev_M);
+  int pos_prev_M = _score - (model.gapo() + model.gape()),
+      pos_prev_D = _score - model.gape(),
+      pos_prev_M_scope = model.scope_pos(pos_prev_M);
   // Come from a Deletion
-  if (pos_prev_D >= 0 && _scope->d_pos(pos_prev_D).size() > _vertices_data->get_id(curr_node_id))
+  if (pos_prev_D >= 0 && _scope->d_pos(model, pos_prev_D).size() > _vertices_data->get_id(curr_node_id))
   {
-    Scope::range cells_range = _scope->d_pos(pos_prev_D)[_vertices_data->get_id(curr_node_id)];
-    sparsify_indel_data(_scope->d_wf(pos_prev_D), 1, -1, cells_range, _seq.size(), upper_bound);
+    Scope::range cells_range = _scope->d_pos(model, pos_prev_D)[_vertices_data->get_id(curr_node_id)];
+    sparsify_indel_data(lane, _scope->d_wf(model, pos_prev_D), 1, -1, cells_range, _seq.size(), upper_bound);
   }
   // Come from M
   if (pos_prev_M >= 0) {
-    if (_scope->m_pos(pos_prev_M).size() > _vertices_data->get_id(curr_node_id))
+    if (_scope->m_pos(model, pos_prev_M).size() > _vertices_data->get_id(curr_node_id))
     {
-      Scope::range cells_range = _scope->m_pos(pos_prev_M)[_vertices_data->get_id(curr_node_id)];
-      sparsify_M_data(_beyond_scope->m_wf(), 1, -1, cells_range, _seq.size(), upper_bound); // Sparsify M data
+      Scope::range cells_range = _scope->m_pos(model, pos_prev_M)[_vertices_data->get_id(curr_node_id)];
+      sparsify_M_data(lane, _beyond_scope->m_wf(), 1, -1, cells_range, _seq.size(), upper_bound); // Sparsify M data
     }
-    sparsify_jumps_data(_beyond_scope->m_jumps_wf(),
+    sparsify_jumps_data(lane, _beyond_scope->m_jumps_wf(),
         _vertices_data->get_vertex_data(curr_node_id)._m_jumps_positions[pos_prev_M_scope],
         1, -1, _seq.size(), upper_bound, Cell::Matrix::MJumps);
   }
   // Densify data (store it in the big wavefront)
   Scope::range new_range;
-  new_range.start = _scope->d_wf(_score).size();
-  for (auto diag : _scratchpad->active_diags()) {
-    if (_vertices_data->valid_diagonal<Cell::Matrix::D>(curr_node_id, diag)
-    && !_heuristics.check_local_heuristics((*_scratchpad)[diag].offset)) {
-      _scope->d_wf(_score).push_back((*_scratchpad)[diag]); // Store Cell
+  new_range.start = lane.d_wf->size();
+  auto active_diags = lane.scratchpad->active_diags();
+  lane.valid_diags.resize(active_diags.size());
+  if (prunes_diagonals(curr_node_id)) {
+    _vertices_data->valid_diagonals<Cell::Matrix::D>(curr_node_id, active_diags, lane.valid_diags.data(),
+                                                                lane.band_validity);
+  }
+  else {
+    std::fill(lane.valid_diags.begin(), lane.valid_diags.end(), 1);
+  }
+  for (size_t l = 0; l < active_diags.size(); ++l) {
+    const auto diag = active_diags[l];
+    if (lane.valid_diags[l] && !prunes_cell(lane, (*lane.scratchpad)[diag].offset)) {
+      lane.d_wf->push_back((*lane.scratchpad)[diag]); // Store Cell
     }
   }
-  new_range.end = _scope->d_wf(_score).size();
-  _scope->d_pos(_score).push_back(new_range);
+  new_range.end = lane.d_wf->size();
+  lane.d_range = new_range;
 }
 
 
 // Compute next M matrix
-void TheseusAlignerImpl::next_M(int upper_bound,
+template <typename Model>
+void TheseusAlignerImpl::next_M(const Model &model,
+                                WaveLane &lane,
+                                int upper_bound,
                                 NodeId curr_node_id) {
   // Sparsify data (put it in the scratch pad)
-  int pos_prev_M = _score - _internal_penalties.mism(),
-      pos_prev_D = _score,
-      pos_prev_I = _score,
-      pos_prev_M_scope = _vertices_data->get_pos(pos_prev_M);
-  // Come from a Deletion
-  if (_scope->d_pos(pos_prev_D).size() > _vertices_data->get_id(curr_node_id))  {
-    Scope::range cells_range = _scope->d_pos(pos_prev_D)[_vertices_data->get_id(curr_node_id)];
-    sparsify_indel_data(_scope->d_wf(pos_prev_D), 0, 0, cells_range, _seq.size(), upper_bound);
-  }
-  // Come from an Insertion
-  if (_scope->i_pos(pos_prev_I).size() > _vertices_data->get_id(curr_node_id))  {
-    Scope::range cells_range = _scope->i_pos(pos_prev_I)[_vertices_data->get_id(curr_node_id)];
-    sparsify_indel_data(_scope->i_wf(pos_prev_I), 0, 0, cells_range, _seq.size(), upper_bound);
-  }
+  int pos_prev_M = _score - model.mism(),
+      pos_prev_M_scope = model.scope_pos(pos_prev_M);
+  // Come from a Deletion (of the current score)
+  sparsify_indel_data(lane, *lane.d_wf, 0, 0, lane.d_range, _seq.size(), upper_bound);
+  // Come from an Insertion (of the current score)
+  sparsify_indel_data(lane, *lane.i_wf, 0, 0, lane.i_range, _seq.size(), upper_bound);
   // Come from M
   if (pos_prev_M >= 0) {
-    if (_scope->m_pos(pos_prev_M).size() > _vertices_data->get_id(curr_node_id))  {
-      Scope::range cells_range = _scope->m_pos(pos_prev_M)[_vertices_data->get_id(curr_node_id)];
-      sparsify_M_data(_beyond_scope->m_wf(), 1, 0, cells_range,  _seq.size(), upper_bound);
+    if (_scope->m_pos(model, pos_prev_M).size() > _vertices_data->get_id(curr_node_id))  {
+      Scope::range cells_range = _scope->m_pos(model, pos_prev_M)[_vertices_data->get_id(curr_node_id)];
+      sparsify_M_data(lane, _beyond_scope->m_wf(), 1, 0, cells_range,  _seq.size(), upper_bound);
     }
-    sparsify_jumps_data(_beyond_scope->m_jumps_wf(),
+    sparsify_jumps_data(lane, _beyond_scope->m_jumps_wf(),
         _vertices_data->get_vertex_data(curr_node_id)._m_jumps_positions[pos_prev_M_scope],
         1, 0, _seq.size(), upper_bound, Cell::Matrix::MJumps);
   }
   // Densify data (store it in the big wavefront)
   Scope::range new_range;
-  new_range.start = _beyond_scope->m_wf().size();
-  for (auto diag : _scratchpad->active_diags()) {
-    if (_vertices_data->valid_diagonal<Cell::Matrix::M>(curr_node_id, diag)
-    && !_heuristics.check_local_heuristics((*_scratchpad)[diag].offset)) {
-      _beyond_scope->m_wf().push_back((*_scratchpad)[diag]);     // Store Cell
+  new_range.start = lane.m_wf->size();
+  auto active_diags = lane.scratchpad->active_diags();
+  lane.valid_diags.resize(active_diags.size());
+  if (prunes_diagonals(curr_node_id)) {
+    _vertices_data->valid_diagonals<Cell::Matrix::M>(curr_node_id, active_diags, lane.valid_diags.data(),
+                                                                lane.band_validity);
+  }
+  else {
+    std::fill(lane.valid_diags.begin(), lane.valid_diags.end(), 1);
+  }
+  for (size_t l = 0; l < active_diags.size(); ++l) {
+    const auto diag = active_diags[l];
+    if (lane.valid_diags[l] && !prunes_cell(lane, (*lane.scratchpad)[diag].offset)) {
+      lane.m_wf->push_back((*lane.scratchpad)[diag]);     // Store Cell
     }
   }
-  new_range.end = _beyond_scope->m_wf().size();
-  _scope->m_pos(_score).push_back(new_range);
+  new_range.end = lane.m_wf->size();
+  lane.m_range = new_range;
+}
+
+
+// Compute next M matrix with linear gaps
+template <typename Model>
+void TheseusAlignerImpl::next_M_linear(const Model &model,
+                                       WaveLane &lane,
+                                       int upper_bound,
+                                       NodeId curr_node_id) {
+  // Sparsify data (put it in the scratch pad)
+  const int v_pos = _vertices_data->get_id(curr_node_id);
+  const int pos_prev_X = _score - model.mism(),
+            pos_prev_G = _score - model.gape();
+  auto &vertex_data = _vertices_data->get_vertex_data(curr_node_id);
+  // Come from M with a mismatch
+  if (pos_prev_X >= 0) {
+    if (_scope->m_pos(model, pos_prev_X).size() > v_pos) {
+      Scope::range cells_range = _scope->m_pos(model, pos_prev_X)[v_pos];
+      sparsify_M_data(lane, _beyond_scope->m_wf(), 1, 0, cells_range, _seq.size(), upper_bound);
+    }
+    sparsify_jumps_data(lane, _beyond_scope->m_jumps_wf(),
+        vertex_data._m_jumps_positions[model.scope_pos(pos_prev_X)],
+        1, 0, _seq.size(), upper_bound, Cell::Matrix::MJumps);
+  }
+  // Come from M with an insertion or a deletion
+  if (pos_prev_G >= 0) {
+    if (_scope->m_pos(model, pos_prev_G).size() > v_pos) {
+      Scope::range cells_range = _scope->m_pos(model, pos_prev_G)[v_pos];
+      sparsify_M_data(lane, _beyond_scope->m_wf(), 0, 1, cells_range, _seq.size(), upper_bound);
+      sparsify_M_data(lane, _beyond_scope->m_wf(), 1, -1, cells_range, _seq.size(), upper_bound);
+    }
+    std::vector<Cell::pos_t> &jumps_positions = vertex_data._m_jumps_positions[model.scope_pos(pos_prev_G)];
+    sparsify_jumps_data(lane, _beyond_scope->m_jumps_wf(), jumps_positions,
+        0, 1, _seq.size(), upper_bound, Cell::Matrix::MJumps);
+    sparsify_jumps_data(lane, _beyond_scope->m_jumps_wf(), jumps_positions,
+        1, -1, _seq.size(), upper_bound, Cell::Matrix::MJumps);
+  }
+  // Densify data (store it in the big wavefront)
+  Scope::range new_range;
+  new_range.start = lane.m_wf->size();
+  auto active_diags = lane.scratchpad->active_diags();
+  lane.valid_diags.resize(active_diags.size());
+  if (prunes_diagonals(curr_node_id)) {
+    _vertices_data->valid_diagonals<Cell::Matrix::M>(curr_node_id, active_diags, lane.valid_diags.data(),
+                                                                lane.band_validity);
+  }
+  else {
+    std::fill(lane.valid_diags.begin(), lane.valid_diags.end(), 1);
+  }
+  for (size_t l = 0; l < active_diags.size(); ++l) {
+    const auto diag = active_diags[l];
+    if (lane.valid_diags[l] && !prunes_cell(lane, (*lane.scratchpad)[diag].offset)) {
+      lane.m_wf->push_back((*lane.scratchpad)[diag]);     // Store Cell
+    }
+  }
+  new_range.end = lane.m_wf->size();
+  lane.m_range = new_range;
 }
 
 
 // Store the jump in neighbours
 void TheseusAlignerImpl::store_M_jump(NodeView curr_node,
-                                      Cell &prev_cell,
+                                      const Cell &prev_cell,
                                       Cell::pos_t prev_pos,
                                       Cell::Matrix from_matrix) {
   // Invalidate the jumping diagonal
@@ -467,7 +1214,6 @@ void TheseusAlignerImpl::store_M_jump(NodeView curr_node,
   //    int vertex_id = _vertices_data->get_id(prev_cell.vertex_id);
   // }
   _vertices_data->invalidate_m_jump(_vertices_data->get_id(prev_cell.vertex_id), prev_cell.diag);
-  int pos_score = _vertices_data->get_pos(_score);
   int new_diag  = -prev_cell.offset;
   Cell new_cell = prev_cell;
   new_cell.from_matrix = from_matrix;
@@ -479,12 +1225,13 @@ void TheseusAlignerImpl::store_M_jump(NodeView curr_node,
     NodeView out_node = get_node(out_node_id);
     _vertices_data->activate_vertex(new_cell.vertex_id);
     // Store jump and metadata
-    bool valid_diag = _vertices_data->valid_diagonal<Cell::Matrix::M>(new_cell.vertex_id, new_cell.diag);
+    bool valid_diag = !prunes_diagonals(new_cell.vertex_id) ||
+                      _vertices_data->valid_diagonal<Cell::Matrix::M>(new_cell.vertex_id, new_cell.diag);
     // Extend only if it has not yet been visited
     if (valid_diag) {
       int pos_new_cell = _beyond_scope->m_jumps_wf().size();
       _beyond_scope->m_jumps_wf().push_back(new_cell);
-      _vertices_data->get_vertex_data(new_cell.vertex_id)._m_jumps_positions[pos_score].push_back(pos_new_cell);
+      _vertices_data->add_m_jump(new_cell.vertex_id, _score, pos_new_cell);
       extend_diagonal(out_node_id, pos_new_cell, Cell::Matrix::MJumps);
     }
   }
@@ -494,13 +1241,12 @@ void TheseusAlignerImpl::store_M_jump(NodeView curr_node,
 // Store the jump in neighbours
 void TheseusAlignerImpl::store_I_jump(
     NodeView curr_node,
-    Cell& prev_cell,
+    const Cell &prev_cell,
     Cell::pos_t prev_pos,
     Cell::Matrix from_matrix)
 {
   // Invalidate the jumping diagonal
   _vertices_data->invalidate_i_jump(_vertices_data->get_id(prev_cell.vertex_id), prev_cell.diag);
-  int pos_score = _vertices_data->get_pos(_score);
   int new_diag = -prev_cell.offset;
   Cell new_cell = prev_cell;
   new_cell.from_matrix = from_matrix;
@@ -510,12 +1256,13 @@ void TheseusAlignerImpl::store_I_jump(
     new_cell.vertex_id = out_node_id;
     new_cell.diag = new_diag;
     _vertices_data->activate_vertex(new_cell.vertex_id);
-    bool valid_diag = _vertices_data->valid_diagonal<Cell::Matrix::I>(new_cell.vertex_id, new_cell.diag);
+    bool valid_diag = !prunes_diagonals(new_cell.vertex_id) ||
+                      _vertices_data->valid_diagonal<Cell::Matrix::I>(new_cell.vertex_id, new_cell.diag);
     // Extend only if it has not yet been visited
     if (valid_diag) {
       int pos_new_cell = _beyond_scope->i_jumps_wf().size();
       _beyond_scope->i_jumps_wf().push_back(new_cell);
-      _vertices_data->get_vertex_data(new_cell.vertex_id)._i_jumps_positions[pos_score].push_back(pos_new_cell);
+      _vertices_data->add_i_jump(new_cell.vertex_id, _score, pos_new_cell);
       // If the destination vertex is empty, jump again
       if (curr_node.sequence.empty()) {
         store_I_jump(curr_node, _beyond_scope->i_jumps_wf()[pos_new_cell], prev_pos, Cell::Matrix::IJumps);
@@ -536,14 +1283,15 @@ void TheseusAlignerImpl::check_and_store_jumps(
   Cell::Matrix from_matrix;
   // Check all diagonals in the current wavefront
   for (int l = 0; l < len; ++l) {
-    diag = curr_wavefront[cell_range.start + l].diag;
-    offset = curr_wavefront[cell_range.start + l].offset;
+    diag = curr_wavefront.diag(cell_range.start + l);
+    offset = curr_wavefront.offset(cell_range.start + l);
     curr_j = diag + offset;
     if (curr_j == n && offset <= (int)_seq.size()) {
-      from_matrix = curr_wavefront[cell_range.start + l].from_matrix;
-      prev_pos = curr_wavefront[cell_range.start + l].prev_pos;
-      store_M_jump(curr_node, curr_wavefront[cell_range.start + l], prev_pos, from_matrix);
-      store_I_jump(curr_node, curr_wavefront[cell_range.start + l], prev_pos, from_matrix);
+      const Cell curr_cell = curr_wavefront[cell_range.start + l];
+      from_matrix = curr_cell.from_matrix;
+      prev_pos = curr_cell.prev_pos;
+      store_M_jump(curr_node, curr_cell, prev_pos, from_matrix);
+      store_I_jump(curr_node, curr_cell, prev_pos, from_matrix);
     }
   }
 }
@@ -553,12 +1301,42 @@ void TheseusAlignerImpl::check_and_store_jumps(
 void TheseusAlignerImpl::LCP(
     NodeView &curr_node,
     int &offset,
-    int &j)
+    int &j,
+    int text_end)
 {
   // Find LCP
   int len_seq_1 = _seq.size();
-  int len_seq_2 = curr_node.sequence.size();
-  // std::cout << query[offset] << " " << curr_node.sequence[j] << std::endl;
+  int len_seq_2 = text_end;
+  int max_len = std::min(len_seq_1 - offset, len_seq_2 - j);
+  if (max_len <= 0) return;
+  // Both views packed and sharing orientation: compare 32 bases per word
+  if (_seq.is_packed() && curr_node.sequence.is_packed() &&
+      _seq.is_reversed() == curr_node.sequence.is_reversed()) {
+    // The node is a window of the packed sequences of the graph
+    const PackedSequence &query = *_seq.packed();
+    const PackedSequence &text  = *curr_node.sequence.packed();
+    const size_t node_begin = curr_node.sequence.packed_offset();
+    const size_t node_end   = node_begin + curr_node.sequence.size();
+    int num_matches = (!_seq.is_reversed()) ?
+                      lcp_packed_forward(query, offset, text, node_begin + j, max_len) :
+                      lcp_packed_backward(query, query.size() - offset, text, node_end - j, max_len);
+    offset = offset + num_matches;   // Update the f.r. of this diagonal
+    j = j + num_matches;
+    return;
+  }
+  // Both views plain and sharing orientation: compare the raw data with the wide kernels
+  if (!_seq.is_packed() && !curr_node.sequence.is_packed() &&
+      _seq.is_reversed() == curr_node.sequence.is_reversed()) {
+    std::string_view query = _seq.underlying();
+    std::string_view text  = curr_node.sequence.underlying();
+    int num_matches = (!_seq.is_reversed()) ?
+                      lcp_forward(query.data() + offset, text.data() + j, max_len) :
+                      lcp_backward(query.data() + query.size() - offset, text.data() + text.size() - j, max_len);
+    offset = offset + num_matches;   // Update the f.r. of this diagonal
+    j = j + num_matches;
+    return;
+  }
+  // Mixed orientations or storages: compare one character at a time
   while (offset < len_seq_1 && j < len_seq_2 && _seq[offset] == curr_node.sequence[j]) {
     offset = offset + 1;   // Update the f.r. of this diagonal
     j = j + 1;
@@ -566,11 +1344,25 @@ void TheseusAlignerImpl::LCP(
 }
 
 
-// TODO: Implement different end conditions as Global, Semi-Global...
+// End conditions: the whole query at any position of the graph (or at the
+// given end), and the ends-free configurations
 void TheseusAlignerImpl::check_end_condition(
     Cell curr_data)
 {
-  if (curr_data.offset == (int)_seq.size()) {
+  bool end_reached;
+  if (_fixed_end) {
+    end_reached = curr_data.offset == (int)_seq.size() && curr_data.vertex_id == _end_node &&
+                  curr_data.diag + curr_data.offset == _end_offset;
+  }
+  else {
+    auto at_sink_end = [&]() {
+      return curr_data.diag + curr_data.offset == _graph.node_size(curr_data.vertex_id) &&
+             !has_out_nodes(curr_data.vertex_id);
+    };
+    end_reached = (curr_data.offset == (int)_seq.size() && (_ends_free.graph_suffix || at_sink_end())) ||
+                  (_ends_free.query_suffix && at_sink_end());
+  }
+  if (end_reached) {
     _alignment.theseus_status = THESEUS_STATUS_ALG_COMPLETED;
     _start_pos = curr_data;
   }
@@ -583,48 +1375,60 @@ void TheseusAlignerImpl::extend_diagonal(
     Cell::pos_t  init_pos,
     Cell::Matrix init_matrix)
 {
-  // Use a explicit stack to avoid recursion and stack overflow
+  // Use a explicit stack to avoid recursion and stack overflow. The stack is
+  // reused between calls, so only the states above its current top are ours.
   // Values: Current node id, current position, current matrix
-  std::stack<std::tuple<NodeId, Cell::pos_t, Cell::Matrix>> extend_stack;
+  auto &extend_stack = _extend_stack;
+  const size_t stack_base = extend_stack.size();
   // Push the initial state onto the stack
-  extend_stack.push(std::make_tuple(init_node_id, init_pos, init_matrix));
+  extend_stack.emplace_back(init_node_id, init_pos, init_matrix);
   // Process the stack until it's empty
-  while (!extend_stack.empty()) {
-    auto [curr_node_id, curr_pos, curr_from_matrix] = extend_stack.top();
-    extend_stack.pop();
+  while (extend_stack.size() > stack_base) {
+    auto [curr_node_id, curr_pos, curr_from_matrix] = extend_stack.back();
+    extend_stack.pop_back();
 
     // Extend the current diagonal
     NodeView curr_node_view = get_node(curr_node_id);
-    Cell* curr_cell_ptr = (curr_from_matrix == Cell::Matrix::M) ? &_beyond_scope->m_wf()[curr_pos] :
-                          &_beyond_scope->m_jumps_wf()[curr_pos];
-    int j = curr_cell_ptr->diag + curr_cell_ptr->offset;
-    LCP(curr_node_view, curr_cell_ptr->offset, j);
+    Cell::CellVector &curr_wf = (curr_from_matrix == Cell::Matrix::M) ? _beyond_scope->m_wf() :
+                                _beyond_scope->m_jumps_wf();
+    int j = curr_wf.diag(curr_pos) + curr_wf.offset(curr_pos);
+    const int text_end = prunes_diagonals(curr_node_id) ? (int)curr_node_view.sequence.size() : _end_offset;
+    LCP(curr_node_view, curr_wf.offset(curr_pos), j, text_end);
+    const Cell curr_cell = curr_wf[curr_pos];
     // End condition
-    check_end_condition(*curr_cell_ptr);
+    check_end_condition(curr_cell);
+    // Furthest cell of the extension mode
+    if (_xdrop_active && curr_cell.offset > _xdrop_cell.offset) {
+      _xdrop_cell = curr_cell;
+    }
+    // Distance to the end of the adaptive reduction
+    if (_adaptive_active) {
+      _heuristics.update_min_distance(curr_cell.offset);
+    }
 
     // Jump to neighbours if the end of the current node is reached
-    if (j == (int)curr_node_view.sequence.size() && curr_cell_ptr->offset <= (int)_seq.size() && has_out_nodes(curr_node_id)) {
+    if (j == (int)curr_node_view.sequence.size() && curr_cell.offset <= (int)_seq.size() && has_out_nodes(curr_node_id)) {
       // Invalidate the jumping diagonal
-      _vertices_data->invalidate_m_jump(_vertices_data->get_id(curr_cell_ptr->vertex_id), curr_cell_ptr->diag);
+      _vertices_data->invalidate_m_jump(_vertices_data->get_id(curr_cell.vertex_id), curr_cell.diag);
       // Compute data of the cell in the next vertex
-      int pos_score = _vertices_data->get_pos(_score);
-      Cell new_cell = *curr_cell_ptr;
+      Cell new_cell = curr_cell;
       new_cell.from_matrix = curr_from_matrix;
       new_cell.prev_pos    = curr_pos;
-      new_cell.diag        = -curr_cell_ptr->offset;
+      new_cell.diag        = -curr_cell.offset;
       // For the corresponding neighbour, store the jump and metadata
       for (auto out_node_id : curr_node_view.out_nodes) {
         new_cell.vertex_id = out_node_id;
         _vertices_data->activate_vertex(new_cell.vertex_id);
         // Store jump and metadata
-        bool valid_diag = _vertices_data->valid_diagonal<Cell::Matrix::M>(new_cell.vertex_id, new_cell.diag);
+        bool valid_diag = !prunes_diagonals(new_cell.vertex_id) ||
+                          _vertices_data->valid_diagonal<Cell::Matrix::M>(new_cell.vertex_id, new_cell.diag);
         // Extend only if it has not yet been visited
         if (valid_diag) {
           int pos_new_cell = _beyond_scope->m_jumps_wf().size();
           _beyond_scope->m_jumps_wf().push_back(new_cell);
-          _vertices_data->get_vertex_data(new_cell.vertex_id)._m_jumps_positions[pos_score].push_back(pos_new_cell);
+          _vertices_data->add_m_jump(new_cell.vertex_id, _score, pos_new_cell);
           // Push the next state onto the stack for the next neighbour
-          extend_stack.push(std::make_tuple(out_node_id, pos_new_cell, Cell::Matrix::MJumps));
+          extend_stack.emplace_back(out_node_id, pos_new_cell, Cell::Matrix::MJumps);
         }
       }
     }
@@ -632,16 +1436,33 @@ void TheseusAlignerImpl::extend_diagonal(
 }
 
 
+void TheseusAlignerImpl::check_xdrop() {
+  if (_alignment.theseus_status == THESEUS_STATUS_OK) {
+    _alignment.theseus_status = _heuristics.check_xdrop(_score, _xdrop_cell.offset);
+    if (_heuristics.best_extension_score() == _score) {
+      _xdrop_best_cell = _xdrop_cell;
+    }
+  }
+  else if (_alignment.theseus_status == THESEUS_STATUS_ALG_COMPLETED) {
+    // The whole alignment is returned unless a shorter extension scores more
+    _heuristics.check_xdrop(_score, _start_pos.offset);
+    if (_heuristics.best_extension_score() != _score) {
+      _alignment.theseus_status = THESEUS_STATUS_ALG_PARTIAL;
+    }
+  }
+}
+
+
 // Initialize the partial backtrace, by finding the starting cell for backtrace.
-// We find this cell by checking all the active cells in scores (s-_s_min, ..., s-_s_min-_scope_size)
-void TheseusAlignerImpl::init_partial_backtrace() {
+// We find this cell by checking all the active cells in scores (s-lookback, ..., s-lookback-_scope_size)
+void TheseusAlignerImpl::init_partial_backtrace(int lookback) {
   Cell best_cell;
   best_cell.offset = -1;
   // Iterate through the valid score range
-  int start_score = _score - _heuristics.s_min() - _scope->size();
+  int start_score = _score - lookback - _scope->size();
   start_score = std::max(0, start_score);
   // Iterate in the M structure for score s TODO: I_jumps?
-  for (int s = start_score; s <= _score - _heuristics.s_min(); ++s) {
+  for (int s = start_score; s <= _score - lookback; ++s) {
     // Check M wavefront
     int start_pos_M = (s == 0) ? 0 : _beyond_scope->m_wf_pos(s-1);
     int end_pos_M   = _beyond_scope->m_wf_pos(s) - 1;
@@ -661,50 +1482,99 @@ void TheseusAlignerImpl::init_partial_backtrace() {
       }
     }
   }
-  _start_pos = best_cell;
+  // If no cell was found, backtrace from the initial cell
+  _start_pos = (best_cell.offset == -1) ? _beyond_scope->m_jumps_wf()[0] : best_cell;
+}
+
+
+// Add edit operations to our backtracking CIGAR
+void TheseusAlignerImpl::add_ops(
+    char op,
+    int length)
+{
+  if (length <= 0) return;
+  switch (_backtrace_sink) {
+    case BacktraceSink::Append:
+      _alignment.add_ops(op, length);
+      break;
+    case BacktraceSink::Count:
+      if (_backtrace_run == 0 || op != _backtrace_op) {
+        ++_backtrace_run;
+        _backtrace_op = op;
+      }
+      break;
+    case BacktraceSink::FillBackwards:
+      if (_backtrace_run < _alignment.cigar.size() && _alignment.cigar[_backtrace_run].op == op) {
+        _alignment.cigar[_backtrace_run].length += length;
+      }
+      else {
+        _alignment.cigar[--_backtrace_run] = CigarRun{op, length};
+      }
+      break;
+  }
 }
 
 
-// Add matches to our backtracking vector
+// Add a vertex to our backtracking path
+void TheseusAlignerImpl::add_path_vertex(NodeId vertex_id)
+{
+  switch (_backtrace_sink) {
+    case BacktraceSink::Append:
+      _alignment.path.push_back(vertex_id);
+      break;
+    case BacktraceSink::Count:
+      ++_backtrace_vertex;
+      break;
+    case BacktraceSink::FillBackwards:
+      _alignment.path[--_backtrace_vertex] = vertex_id;
+      break;
+  }
+}
+
+
+// Add matches to our backtracking CIGAR
 void TheseusAlignerImpl::add_matches(
     int start_matches,
     int end_matches)
 {
-  int size = end_matches - start_matches;
-  for (int k = 0; k < size; ++k) {
-    _alignment.edit_op.push_back('M');
-  }
+  add_ops('M', end_matches - start_matches);
 }
 
 
-// Add a mismatch to our backtracking vector
+// Add a mismatch to our backtracking CIGAR
 void TheseusAlignerImpl::add_mismatch()
 {
-  _alignment.edit_op.push_back('X');
+  add_ops('X', 1);
+}
+
+
+// Add insertions to our backtracking CIGAR
+void TheseusAlignerImpl::add_insertions(int num_insertions)
+{
+  add_ops('I', num_insertions);
 }
 
 
-// Add an insertion to our backtracking vector
-void TheseusAlignerImpl::add_insertion()
+// Add deletions to our backtracking CIGAR
+void TheseusAlignerImpl::add_deletions(int num_deletions)
 {
-  _alignment.edit_op.push_back('I');
+  add_ops('D', num_deletions);
 }
 
 
-// Add a deletion to our backtracking vector
-void TheseusAlignerImpl::add_deletion()
+Cell TheseusAlignerImpl::previous_cell(
+    const Cell &curr_cell)
 {
-  _alignment.edit_op.push_back('D');
+  if (curr_cell.from_matrix == Cell::Matrix::M) return _beyond_scope->m_wf()[curr_cell.prev_pos];
+  else if (curr_cell.from_matrix == Cell::Matrix::MJumps) return _beyond_scope->m_jumps_wf()[curr_cell.prev_pos];
+  else return _beyond_scope->i_jumps_wf()[curr_cell.prev_pos];
 }
 
 
 void TheseusAlignerImpl::one_backtrace_step(
-    Cell &curr_cell)
+    const Cell &curr_cell,
+    const Cell &prev_cell)
 {
-  Cell prev_cell;
-  if (curr_cell.from_matrix == Cell::Matrix::M) prev_cell = _beyond_scope->m_wf()[curr_cell.prev_pos];
-  else if (curr_cell.from_matrix == Cell::Matrix::MJumps) prev_cell = _beyond_scope->m_jumps_wf()[curr_cell.prev_pos];
-  else prev_cell = _beyond_scope->i_jumps_wf()[curr_cell.prev_pos];
   int num_indels;
   bool is_jump = ((curr_cell.vertex_id != prev_cell.vertex_id));
   // We are inside the same vertex
@@ -721,26 +1591,35 @@ void TheseusAlignerImpl::one_backtrace_step(
       if (curr_cell.diag < prev_cell.diag) {
         num_indels = prev_cell.diag - curr_cell.diag;
         add_matches(prev_cell.offset + num_indels, curr_cell.offset);
-        for (int l = 0; l < num_indels; ++l) add_deletion();
+        add_deletions(num_indels);
       }
       // Insertion
       else {
         num_indels = curr_cell.diag - prev_cell.diag;
         add_matches(prev_cell.offset, curr_cell.offset);
-        for (int l = 0; l < num_indels; ++l) add_insertion();
+        add_insertions(num_indels);
       }
     }
   }
   // Jump to another vertex
   else {
     add_matches(prev_cell.offset, curr_cell.offset);                          // Add the necessary matches
-    _alignment.path.push_back(prev_cell.vertex_id);                           // Add the new vertex to the path
+    add_path_vertex(prev_cell.vertex_id);                                     // Add the new vertex to the path
     int col_in_prev_v = prev_cell.diag + prev_cell.offset;
     int num_insertions = _graph.node_size(prev_cell.vertex_id) - col_in_prev_v;
-    for (int l = 0; l < num_insertions; ++l) add_insertion();                 // Add the necessary insertions
+    add_insertions(num_insertions);                                           // Add the necessary insertions
   }
-  // Update current cell
-  curr_cell = prev_cell;
+}
+
+
+void TheseusAlignerImpl::emit_backtrace()
+{
+  add_path_vertex(_backtrace_cells.front().vertex_id);
+  for (size_t l = 0; l + 1 < _backtrace_cells.size(); ++l) {
+    one_backtrace_step(_backtrace_cells[l], _backtrace_cells[l + 1]);
+  }
+  // Add the matches until the beginning of the sequence
+  add_matches(0, _backtrace_cells.back().offset);
 }
 
 
@@ -750,19 +1629,29 @@ void TheseusAlignerImpl::backtrace()
   Cell curr_pos = _start_pos;
   _alignment.start_offset = _start_offset;
   _alignment.end_offset = curr_pos.diag + curr_pos.offset; // Vertex offset = j
-  _alignment.path.push_back(curr_pos.vertex_id);
-  // Main backtrace loop
-  while (curr_pos.prev_pos != -1)
-  {
-    one_backtrace_step(curr_pos);
+  _alignment.query_end = curr_pos.offset;
+  // Cells of the alignment, from its end to its start
+  _backtrace_cells.clear();
+  _backtrace_cells.push_back(curr_pos);
+  while (curr_pos.prev_pos != -1) {
+    curr_pos = previous_cell(curr_pos);
+    _backtrace_cells.push_back(curr_pos);
   }
-  // Add the matches until the beginning of the sequence
-  add_matches(0, curr_pos.offset);
-  // Reverse path and edit operations
-  if (!_reversed_alignment) {
-    std::reverse(_alignment.edit_op.begin(), _alignment.edit_op.end());
-    std::reverse(_alignment.path.begin(), _alignment.path.end());
+  // The operations of a reversed alignment are found in their final order
+  if (_reversed_alignment) {
+    _backtrace_sink = BacktraceSink::Append;
+    emit_backtrace();
+    return;
   }
+  // Otherwise, count the runs and vertices, and write them from the back
+  _backtrace_sink = BacktraceSink::Count;
+  _backtrace_run = _backtrace_vertex = 0;
+  emit_backtrace();
+  _alignment.cigar.resize(_backtrace_run);
+  _alignment.path.resize(_backtrace_vertex);
+  _backtrace_sink = BacktraceSink::FillBackwards;
+  emit_backtrace();
+  _backtrace_sink = BacktraceSink::Append;
 }
 
 
@@ -861,13 +1750,13 @@ void TheseusAlignerImpl::print_as_gaf(
   out_stream << seq_name;
 
   // Field 2: Query length
-  out_stream << "\t" << _seq.size();
+  out_stream << "\t" << alignment.query_length;
 
   // Field 3: Query start
   out_stream << "\t" << 0;
 
   // Field 4: Query end
-  out_stream << "\t" << _seq.size();
+  out_stream << "\t" << alignment.query_end;
 
   // Field 5: Strand
   out_stream << "\t" << "+"; // TODO: Support reverse strand
@@ -887,43 +1776,34 @@ void TheseusAlignerImpl::print_as_gaf(
   out_stream << "\t" << target_length;
 
   // Field 8: Target start
-  out_stream << "\t" << _start_offset;
+  out_stream << "\t" << alignment.start_offset;
 
   // Field 9: Target end
   out_stream << "\t" << alignment.end_offset;
 
   // Field 10: Number of matching bases
   int num_matches = 0;
-  for (size_t l = 0; l < alignment.edit_op.size(); ++l) {
-    if (alignment.edit_op[l] == 'M') {
-      num_matches += 1;
+  int block_length = 0;
+  for (const CigarRun &run : alignment.cigar) {
+    if (run.op == 'M') {
+      num_matches += run.length;
     }
+    block_length += run.length;
   }
   out_stream << "\t" << num_matches;
 
   // Field 11: Alignment block length
-  out_stream << "\t" << alignment.edit_op.size();
+  out_stream << "\t" << block_length;
 
   // Field 12: Mapping quality
   out_stream << "\t" << 255; // TODO: Compute mapping quality
 
   // Optional fields
   out_stream << "\t" << "cg:Z:"; // CIGAR string
-  std::string cigar = "";
-  int count = 1;
-  for (size_t l = 1; l < alignment.edit_op.size(); ++l) {
-    if (alignment.edit_op[l] == alignment.edit_op[l - 1]) {
-      count += 1;
-    }
-    else {
-      cigar += std::to_string(count) + alignment.edit_op[l - 1];
-      count = 1;
-    }
-  }
-  if (alignment.edit_op.size() > 0) {
-    cigar += std::to_string(count) + alignment.edit_op.back();
+  for (const CigarRun &run : alignment.cigar) {
+    out_stream << run.length << run.op;
   }
-  out_stream << cigar << "\n";
+  out_stream << "\n";
 }
 
 } // namespace theseus
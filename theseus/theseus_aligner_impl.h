@@ -37,6 +37,7 @@
 #include <stack>
 #include <utility>
 #include <tuple>
+#include <limits>
 
 #include "theseus/alignment.h"
 #include "theseus/penalties.h"
@@ -50,7 +51,10 @@
 #include "vertices_data.h"
 #include "wavefront.h"
 #include "internal_penalties.h"
+#include "penalty_model.h"
+#include "lcp.h"
 #include "msa.h"
+#include "wave_pool.h"
 
 namespace theseus {
 
@@ -67,6 +71,18 @@ public:
                        int  initial_weight,
                        bool is_msa);
 
+    /**
+     * @brief Sequence-to-graph aligner over penalties and a graph shared with
+     * other aligners. Both are only read, so several aligners can share them
+     * while they run on different threads.
+     *
+     * @param penalties          Shared (validated) penalties
+     * @param graph              Shared graph to align to
+     */
+    TheseusAlignerImpl(std::shared_ptr<const PenaltyModels> penalties,
+                       const Heuristics &heuristics,
+                       std::shared_ptr<const Graph> graph);
+
     /**
      * @brief Main alignment function. Aligns the given sequence to the graph
      * starting at the specified node and offset.
@@ -77,7 +93,7 @@ public:
      * @param weight             Weight of the sequence to be aligned (used for MSA)
      * @param add_to_graph       Whether to add the alignment to the POA graph (MSA mode only)
      * @param reverse_alignment  Whether to perform reverse alignment
-     * @param is_ends_free       Whether to allow a free end on the "end" of the graph
+     * @param ends_free          Ends-free options (sequence-to-graph mode only)
      *
      * @return                  Alignment object
      */
@@ -87,13 +103,117 @@ public:
                     int  start_offset,
                     // MSA parameters
                     int  weight = 1,
-                    bool is_ends_free = false,
+                    EndsFree ends_free = {},
+                    // Common parameters
+                    bool reverse_alignment = false,
+                    bool density_drop_active = false,
+                    bool lag_pruning_active = false,
+                    bool add_to_graph = true);
+
+    /**
+     * @brief Same as align, but the result is written into "alignment",
+     * reusing its buffers. Together with the buffers kept by the aligner, no
+     * memory is allocated once they are large enough.
+     *
+     * @param alignment          Output alignment (its previous contents are discarded)
+     */
+    void align_into(Alignment &alignment,
+                    std::string_view seq,
+                    // Seq-to-graph parameters
+                    int  start_node,
+                    int  start_offset,
+                    // MSA parameters
+                    int  weight = 1,
+                    EndsFree ends_free = {},
                     // Common parameters
                     bool reverse_alignment = false,
                     bool density_drop_active = false,
                     bool lag_pruning_active = false,
                     bool add_to_graph = true);
 
+    /**
+     * @brief Compute only the score and the end position of the alignment. The
+     * cells are only kept while they are in the scope, so the memory depends
+     * on the width of the wavefronts instead of on the number of cells
+     * computed. The POA graph is never modified.
+     *
+     * @param seq                Sequence to be aligned
+     * @param start_node         Starting node in the graph
+     * @param start_offset       Starting offset within the starting node
+     *
+     * @return                  Score and end position of the alignment
+     */
+    AlignmentScore align_score(std::string_view seq,
+                               int  start_node,
+                               int  start_offset,
+                               bool reverse_alignment = false,
+                               bool density_drop_active = false,
+                               bool lag_pruning_active = false,
+                               EndsFree ends_free = {});
+
+    /**
+     * @brief Align the sequence end to end splitting it recursively at the
+     * point where a forward and a reverse half-alignment meet (as in BiWFA).
+     * The end of the alignment is found with a score-only pass, and each half
+     * is computed in score-only mode, so the memory grows with the width of
+     * the wavefronts instead of with the number of cells. Segments with a low
+     * score are aligned directly. The result is an optimal alignment, but
+     * ties may be broken differently than by align.
+     *
+     * @param alignment          Output alignment (its previous contents are discarded)
+     * @param seq                Sequence to be aligned
+     * @param start_node         Starting node in the graph (ignored in MSA mode)
+     * @param start_offset       Starting offset within the starting node
+     * @param weight             Weight of the sequence to be aligned (used for MSA)
+     * @param add_to_graph       Whether to add the alignment to the POA graph (MSA mode only)
+     */
+    void align_bidirectional_into(Alignment &alignment,
+                                  std::string_view seq,
+                                  int  start_node,
+                                  int  start_offset,
+                                  int  weight = 1,
+                                  bool add_to_graph = true);
+
+    /**
+     * @brief Replace the heuristics (including the budgets) used by the
+     * following alignments.
+     *
+     * @param heuristics         Heuristics object
+     */
+    void set_heuristics(const Heuristics &heuristics);
+
+    /**
+     * @brief Set the number of scores between checkpoints. With an interval k
+     * greater than zero, align only keeps the M cells of the scope every k
+     * scores, and the backtrace recomputes the segments of the alignment
+     * between consecutive checkpoints. A lower k uses more memory for the
+     * checkpoints and less for the segments. Zero (the default) keeps all the
+     * cells.
+     *
+     * @param interval           Number of scores between checkpoints
+     */
+    void set_checkpoint_interval(int interval);
+
+    /**
+     * @brief Compute the wavefronts of the vertices of each score on several
+     * threads. The next wavefronts of the vertices only depend on the
+     * wavefronts of previous scores, so they are computed (and extended within
+     * their vertex) concurrently, each thread with its own scratchpad and
+     * output buffers. Then the cells are moved to the wavefronts of the score
+     * and the jumps between vertices are followed in the order of the
+     * vertices, so the alignment does not depend on the number of threads.
+     * The score is the same as with the sequential wave, but the jumps of a
+     * score only prune the diagonals from the next one, so more cells may be
+     * computed and ties may be broken differently.
+     *
+     * @param num_threads  Number of threads (0 or 1 restores the sequential wave)
+     */
+    void set_parallel_wave(int num_threads);
+
+    const Heuristics &heuristics() const { return _heuristics; }
+    int checkpoint_interval() const { return _checkpoint_interval; }
+    int parallel_wave() const { return _wave_pool ? _wave_pool->size() : 1; }
+
     /**
      * @brief Output the current graph in GFA format.
      *
@@ -144,6 +264,36 @@ public:
             std::unordered_map<NodeId, std::string> &node_names);
 
 private:
+    // Buffers used to compute the next wavefronts of a vertex. The sequential
+    // wave stores the cells directly in the wavefronts of the score; each
+    // thread of the parallel wave stores them in its own wavefronts, which are
+    // moved to those of the score once all the vertices are computed.
+    struct WaveLane {
+        std::unique_ptr<ScratchPad> scratchpad = std::make_unique<ScratchPad>(2048);
+        Vector<Cell::pos_t, true> sparsify_candidates;  // Reused by the sparsify kernels
+        std::vector<uint8_t> valid_diags;               // Validity of the scratchpad diagonals
+        std::vector<uint8_t> band_validity;             // Buffer of VerticesData::valid_diagonals
+        bool concurrent = false;                        // Whether it is a lane of the parallel wave
+        int  max_offset = 0;                            // Furthest offset checked (concurrent lanes)
+        // Output wavefronts and cells of the last vertex computed
+        Cell::CellVector *i_wf = nullptr, *d_wf = nullptr, *m_wf = nullptr;
+        Scope::range i_range, d_range, m_range;
+        // Wavefronts of a concurrent lane
+        Cell::CellVector own_i_wf, own_d_wf, own_m_wf;
+    };
+
+    // Cells of a vertex computed in a lane of the parallel wave
+    struct LaneCells {
+        int lane;
+        Scope::range i_range, d_range, m_range;
+    };
+
+    TheseusAlignerImpl(std::shared_ptr<const PenaltyModels> penalties,
+                       const Heuristics &heuristics,
+                       std::shared_ptr<Graph> graph,
+                       int  initial_weight,
+                       bool is_msa);
+
     /**
      * @brief Initialize the data for a new alignment.
      *
@@ -153,21 +303,183 @@ private:
                        bool density_drop_active,
                        bool lag_pruning_active);
 
+    /**
+     * @brief Compute the wavefronts of the alignment of seq from (_start_node,
+     * _start_offset) until the end condition holds, the heuristics stop it or
+     * _max_score is exceeded. _score is left at the last score computed.
+     *
+     */
+    void run_alignment(std::string_view seq,
+                       bool reverse_alignment,
+                       bool density_drop_active,
+                       bool lag_pruning_active);
+
+    /**
+     * @brief Align seq from (start_node, start_column) to (end_node,
+     * end_column), whose optimal score is expected to be "score", and append
+     * the result to _bidirectional_alignment.
+     *
+     * @return The score of the appended alignment, or -1 if it was not found
+     * within the expected score
+     */
+    int align_segment(std::string_view seq,
+                      NodeId start_node,
+                      int    start_column,
+                      NodeId end_node,
+                      int    end_column,
+                      int    score);
+
+    /**
+     * @brief Same as align_segment, but the segment is never split.
+     *
+     * @return The score of the appended alignment, or -1 if it was not found
+     * within the expected score
+     */
+    int align_segment_directly(std::string_view seq,
+                               NodeId start_node,
+                               int    start_column,
+                               NodeId end_node,
+                               int    end_column,
+                               int    score);
+
+    /**
+     * @brief Run the forward half of the alignment up to half the score and the
+     * reverse half until it meets the forward one, storing the meeting point
+     * in _breakpoint.
+     *
+     * @return Whether a breakpoint was found
+     */
+    bool find_breakpoint(std::string_view seq,
+                         NodeId start_node,
+                         int    start_column,
+                         NodeId end_node,
+                         int    end_column,
+                         int    score);
+
+    /**
+     * @brief Compute the reverse alignment from (end_node, end_column) until
+     * it meets one of the _meeting_cells with a total score within "score",
+     * storing the meeting point in _breakpoint.
+     *
+     * @return Whether a breakpoint was found
+     */
+    bool search_breakpoint(std::string_view seq,
+                           NodeId start_node,
+                           int    start_column,
+                           NodeId end_node,
+                           int    end_column,
+                           int    score,
+                           int    max_reverse_score);
+
+    /**
+     * @brief Store the M cells of the scope of the current score as a
+     * checkpoint.
+     *
+     */
+    void store_checkpoint();
+
+    /**
+     * @brief Backtrace of the checkpoint mode. The alignment is split at the
+     * checkpoint cells found by reverse alignments from its end, and the
+     * segments between them are recomputed keeping all their cells. The
+     * result is left in _alignment.
+     *
+     * @return Whether the alignment was recovered within the optimal score
+     */
+    bool checkpoint_backtrace(std::string_view seq);
+
+    /**
+     * @brief Check whether an M cell of the current score of the reverse half
+     * overlaps one of the forward half with a total score within the expected
+     * one.
+     *
+     */
+    bool check_breakpoint();
+
     /**
      * @brief Process a given vertex at a given _score. This means performing
      * the next and extend operations.
      *
+     * @param model Penalty model of the kernels
      * @param curr_node_id
      */
+    template <typename Model>
     void process_vertex(
+        const Model &model,
         NodeId curr_node_id);
 
     /**
-     * @brief Compute the wave for a given score for all active vertices.
+     * @brief Compute the next wavefronts of a vertex into the output
+     * wavefronts of a lane. In a concurrent lane, the M cells are also
+     * extended within the vertex, and the jumps are left to the merge.
+     *
+     * @param model Penalty model of the kernels
+     * @param lane Buffers of the thread
+     * @param curr_node_id
+     */
+    template <typename Model>
+    void compute_vertex(
+        const Model &model,
+        WaveLane &lane,
+        NodeId curr_node_id);
+
+    /**
+     * @brief Compute the wave for a given score for all active vertices, with
+     * the kernels of the penalty model of the aligner.
      *
      */
     void compute_new_wave();
 
+    /**
+     * @brief Compute the wave for a given score for all active vertices.
+     *
+     * @param model Penalty model of the kernels
+     */
+    template <typename Model>
+    void compute_new_wave(const Model &model);
+
+    /**
+     * @brief Compute the wave of a score with the parallel wave (see
+     * set_parallel_wave).
+     *
+     * @param model Penalty model of the kernels
+     */
+    template <typename Model>
+    void compute_new_wave_parallel(const Model &model);
+
+    /**
+     * @brief Local heuristics of a cell computed in a lane.
+     *
+     * @return Whether the cell is pruned
+     */
+    bool prunes_cell(WaveLane &lane, int offset);
+
+    /**
+     * @brief Filter pass of the sparsify kernels. Stores in lane.sparsify_candidates
+     * the positions of dense_wf (given by pos_at(0), ..., pos_at(len - 1)) whose
+     * shifted cell stays inside the bounds of the current vertex. The merge pass
+     * then only visits the surviving cells, in the same order.
+     *
+     * @param dense_wf
+     * @param len
+     * @param pos_at
+     * @param offset_increase
+     * @param shift_factor
+     * @param m
+     * @param upper_bound
+     * @return Number of candidates
+     */
+    template <typename PosAt>
+    Cell::pos_t filter_sparsify_candidates(
+        WaveLane &lane,
+        const Cell::CellVector &dense_wf,
+        Cell::pos_t len,
+        PosAt pos_at,
+        int offset_increase,
+        int shift_factor,
+        int m,
+        int upper_bound);
+
     /**
      * @brief Sparsify the M data. This means storing the data in the scratchpad
      * to be later processed.
@@ -180,6 +492,7 @@ private:
      * @param upper_bound
      */
     void sparsify_M_data(
+        WaveLane &lane,
         Cell::CellVector &dense_wf,
         int offset_increase,
         int shift_factor,
@@ -200,6 +513,7 @@ private:
      * @param from_matrix
      */
     void sparsify_jumps_data(
+        WaveLane &lane,
         Cell::CellVector &dense_wf,
         std::vector<Cell::pos_t> &jumps_positions,
         int offset_increase,
@@ -220,6 +534,7 @@ private:
      * @param upper_bound
      */
     void sparsify_indel_data(
+        WaveLane &lane,
         Cell::CellVector &dense_wf,
         int offset_increase,
         int shift_factor,
@@ -232,10 +547,14 @@ private:
      * the data in the scratchpad and storing it back on the new wavefront, once the
      * corresponding maximums and checks have been done.
      *
+     * @param model Penalty model of the kernels
      * @param upper_bound // Maximum value of the diagonal
      * @param curr_node_id
      */
+    template <typename Model>
     void next_I(
+        const Model &model,
+        WaveLane &lane,
         int upper_bound,
         NodeId curr_node_id);
 
@@ -244,10 +563,14 @@ private:
      * the data in the scratchpad and storing it back on the new wavefront, once the
      * corresponding maximums and checks have been done.
      *
+     * @param model Penalty model of the kernels
      * @param upper_bound // Maximum value of the diagonal
      * @param curr_node_id
      */
+    template <typename Model>
     void next_D(
+        const Model &model,
+        WaveLane &lane,
         int upper_bound,
         NodeId curr_node_id);
 
@@ -256,10 +579,30 @@ private:
      * the data in the scratchpad and storing it back on the new wavefront, once the
      * corresponding maximums and checks have been done.
      *
+     * @param model Penalty model of the kernels
      * @param upper_bound // Maximum value of the diagonal
      * @param curr_node_id
      */
+    template <typename Model>
     void next_M(
+        const Model &model,
+        WaveLane &lane,
+        int upper_bound,
+        NodeId curr_node_id);
+
+    /**
+     * @brief Compute the next M wavefront of a vertex with linear gaps. Gaps
+     * are taken from the M wavefront gape scores back, so there are no I and
+     * D wavefronts.
+     *
+     * @param model Penalty model of the kernels
+     * @param upper_bound // Maximum value of the diagonal
+     * @param curr_node_id
+     */
+    template <typename Model>
+    void next_M_linear(
+        const Model &model,
+        WaveLane &lane,
         int upper_bound,
         NodeId curr_node_id);
 
@@ -274,7 +617,7 @@ private:
      */
     void store_M_jump(
         NodeView curr_node,
-        Cell &prev_cell,
+        const Cell &prev_cell,
         Cell::pos_t prev_pos,
         Cell::Matrix from_matrix);
 
@@ -289,7 +632,7 @@ private:
      */
     void store_I_jump(
         NodeView curr_node,
-        Cell &prev_cell,
+        const Cell &prev_cell,
         Cell::pos_t prev_pos,
         Cell::Matrix from_matrix);
 
@@ -313,11 +656,13 @@ private:
      * @param text
      * @param offset
      * @param j
+     * @param text_end  Column where the comparison stops in the vertex
      */
     void LCP(
         NodeView &curr_node,
         int &offset,
-        int &j);
+        int &j,
+        int text_end);
 
     /**
      * @brief Check the end condition for the alignment.
@@ -343,11 +688,37 @@ private:
     /**
      * @brief Initialize the partial backtrace, by finding the starting cell for backtrace.
      *
+     * @param lookback Number of scores before the last one where the cells are looked for
+     */
+    void init_partial_backtrace(int lookback);
+
+    /**
+     * @brief Extension mode: update the best extension with the furthest cell
+     * reached so far and stop the alignment with THESEUS_STATUS_ALG_PARTIAL
+     * when it falls too far behind (or when the whole alignment scores less
+     * than the best extension).
+     *
+     */
+    void check_xdrop();
+
+    /**
+     * @brief Add edit operations to our backtracking CIGAR, or count them
+     * (see BacktraceSink).
+     *
+     * @param op
+     * @param length
+     */
+    void add_ops(char op, int length);
+
+    /**
+     * @brief Add a vertex to our backtracking path, or count it.
+     *
+     * @param vertex_id
      */
-    void init_partial_backtrace();
+    void add_path_vertex(NodeId vertex_id);
 
     /**
-     * @brief Add matches to our backtracking vector.
+     * @brief Add matches to our backtracking CIGAR.
      *
      * @param start_matches
      * @param end_matches
@@ -355,30 +726,51 @@ private:
     void add_matches(int start_matches, int end_matches);
 
     /**
-     * @brief Add a mismatch to our backtracking vector.
+     * @brief Add a mismatch to our backtracking CIGAR.
      *
      */
     void add_mismatch();
 
     /**
-     * @brief Add an insertion to our backtracking vector.
+     * @brief Add insertions to our backtracking CIGAR.
+     *
+     * @param num_insertions
+     */
+    void add_insertions(int num_insertions);
+
+    /**
+     * @brief Add deletions to our backtracking CIGAR.
      *
+     * @param num_deletions
      */
-    void add_insertion();
+    void add_deletions(int num_deletions);
 
     /**
-     * @brief Add a deletion to our backtracking vector.
+     * @brief Get the cell a given cell comes from.
      *
+     * @param curr_cell
+     * @return Cell
      */
-    void add_deletion();
+    Cell previous_cell(
+        const Cell &curr_cell);
 
     /**
-     * @brief Perform a single step of the backtrace process.
+     * @brief Perform a single step of the backtrace process, from a cell to the
+     * cell it comes from. The operations are added from the end of the step.
      *
      * @param curr_cell
+     * @param prev_cell
      */
     void one_backtrace_step(
-        Cell &curr_cell);
+        const Cell &curr_cell,
+        const Cell &prev_cell);
+
+    /**
+     * @brief Add the operations and vertices of the cells in _backtrace_cells,
+     * from the end of the alignment to its start.
+     *
+     */
+    void emit_backtrace();
 
     /**
      * @brief Backtrace the alignment from the end vertex to the start vertex.
@@ -402,43 +794,125 @@ private:
      */
     void print_code_graphviz_internal(std::ostream &out_stream);
 
+    // The pruning of the diagonals assumes that the alignment can end anywhere
+    // once the sequence is consumed, so it is disabled on a fixed end vertex
+    bool prunes_diagonals(NodeId id) const {
+        return !_fixed_end || id != _end_node;
+    }
+
+    // Last column that the cells of a vertex can reach. A fixed end vertex is
+    // truncated at the end column: otherwise the cells that overtake the end
+    // column would hide the gaps that end there.
+    int column_bound(NodeId id) const {
+        return prunes_diagonals(id) ? _graph.node_size(id) : _end_offset;
+    }
+
     // Handle reverse alignment
     NodeView get_node(NodeId id);
     bool has_out_nodes(NodeId id);
 
+    // M cell of the forward half of a bidirectional alignment
+    struct MeetingCell {
+        NodeId vertex_id;
+        int diag;
+        int offset;
+        int score;
+
+        bool operator<(const MeetingCell &other) const {
+            return std::tie(vertex_id, diag, score, offset) <
+                   std::tie(other.vertex_id, other.diag, other.score, other.offset);
+        }
+    };
+
+    // Point where a bidirectional alignment is split
+    struct Breakpoint {
+        NodeId vertex_id;
+        int column;         // Column in the vertex
+        int offset;         // Position in the sequence
+        int prefix_score;
+        int suffix_score;
+    };
+
+    // Scores below this one are not split by the bidirectional alignment
+    static constexpr int bidirectional_base_score = 64;
+
     int32_t _score = 0;
+    int32_t _max_score = std::numeric_limits<int32_t>::max(); // Last score computed by run_alignment
 
-    Penalties _penalties;
-    InternalPenalties _internal_penalties;
+    std::shared_ptr<const PenaltyModels> _penalties;   // Shared with the other aligners of the graph
 
     std::unique_ptr<POAGraph> _poa_graph; // Partial order alignment graph for MSA
 
-    bool _ends_free;
+    EndsFree _ends_free;
+    bool _score_only = false;   // Whether the cells out of the scope can be released
+    bool _budgets_active = false;   // Whether the budgets of the heuristics apply to this run
+    bool _xdrop_active = false;     // Whether the X-drop of the heuristics applies to this run
+    bool _adaptive_active = false;  // Whether the adaptive reduction of the heuristics applies to this run
+    Cell _xdrop_cell;               // Furthest cell of the current alignment (extension mode)
+    Cell _xdrop_best_cell;          // Furthest cell at the score of the best extension
     bool _reversed_alignment;
     int  _start_column;
     int  _seq_ID = 0;
     NodeId _start_node;
     NodeId _end_node;
+    int  _end_offset;
+    bool _fixed_end = false;   // Whether the alignment has to end at (_end_node, _end_offset)
     int  _start_offset;
     Cell _start_pos;
     Cell::Matrix _start_matrix;
 
-    std::unique_ptr<ScratchPad> _scratchpad;
+    WaveLane _lane;                                 // Buffers of the sequential wave
+
+    // Backtrace: the operations are found from the end of the alignment. A
+    // forward alignment counts its runs and path vertices first, and then
+    // writes them from the back of the CIGAR and the path, so they end up in
+    // their final order.
+    enum class BacktraceSink { Append, Count, FillBackwards };
+    BacktraceSink _backtrace_sink = BacktraceSink::Append;
+    std::vector<Cell> _backtrace_cells;             // Cells of the alignment, from its end
+    size_t _backtrace_run;                          // Runs counted, or next run to write
+    size_t _backtrace_vertex;                       // Vertices counted, or next vertex to write
+    char   _backtrace_op;                           // Last operation counted
+    std::vector<std::tuple<NodeId, Cell::pos_t, Cell::Matrix>> _extend_stack;  // Pending extensions
 
     std::unique_ptr<Scope> _scope;
     std::unique_ptr<BeyondScope> _beyond_scope;
 
     std::unique_ptr<VerticesData> _vertices_data;
 
+    // Parallel wave
+    std::unique_ptr<WavePool> _wave_pool;           // Null with the sequential wave
+    std::vector<WaveLane> _wave_lanes;              // One per thread of the pool
+    std::vector<LaneCells> _lane_cells;             // Per live vertex of the current score
+
     Heuristics _heuristics;
 
-    Graph _graph;   // The graph to align to
+    std::shared_ptr<const Graph> _shared_graph; // Owner of the graph (shared with the other aligners)
+    const Graph &_graph;                        // The graph to align to
+    std::shared_ptr<Graph> _msa_graph;          // The same graph, updated with the alignments (MSA only)
 
     bool _is_msa;
 
     SequenceView _seq;
+    PackedSequence _packed_seq;   // Backing storage of _seq if the graph is packed
 
     Alignment _alignment;
+
+    // Bidirectional alignment
+    bool _search_breakpoint = false;          // Whether the reverse half is looking for the forward one
+    bool _breakpoint_found;
+    int  _breakpoint_score;                   // Score of the segment being split
+    Breakpoint _breakpoint;
+    std::vector<MeetingCell> _meeting_cells;  // Sorted by vertex and diagonal
+    Alignment _bidirectional_alignment;       // Segments aligned so far
+
+    // Checkpoint mode
+    int  _checkpoint_interval = 0;            // Scores between checkpoints (0 keeps all the cells)
+    bool _checkpointing = false;              // Whether the current alignment stores checkpoints
+    std::vector<MeetingCell> _checkpoint_cells;     // Cells of all the checkpoints
+    std::vector<size_t> _checkpoint_starts;         // First cell of each checkpoint
+    std::vector<int> _checkpoint_scores;            // Score of each checkpoint
+    std::vector<Breakpoint> _checkpoint_breakpoints;  // From the end to the start of the alignment
 };
 
 }   // namespace theseus
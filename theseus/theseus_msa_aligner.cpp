@@ -72,7 +72,7 @@ Alignment TheseusMSA::align(
     int  weight,
     bool lag_pruning_active
 ) {
-    return msa_aligner_impl_->align(seq, 0, 0, weight, false, false, false, lag_pruning_active, true);
+    return msa_aligner_impl_->align(seq, 0, 0, weight, EndsFree{}, false, false, lag_pruning_active, true);
 }
 
 /**
@@ -84,7 +84,62 @@ Alignment TheseusMSA::align(
 Alignment TheseusMSA::align_only(
     std::string_view seq) {
 
-    return msa_aligner_impl_->align(seq, 0, 0, 1, false, false, false, false, false);
+    return msa_aligner_impl_->align(seq, 0, 0, 1, EndsFree{}, false, false, false, false);
+}
+
+/**
+ * @brief Compute the score of the alignment against the underlying POA graph.
+ *
+ * @param seq
+ * @return AlignmentScore
+ */
+AlignmentScore TheseusMSA::align_score(
+    std::string_view seq) {
+
+    return msa_aligner_impl_->align_score(seq, 0, 0);
+}
+
+/**
+ * @brief Add a sequence to the POA graph using the linear-memory alignment.
+ *
+ * @param seq
+ * @param weight              Sequence weight
+ * @return Alignment
+ */
+Alignment TheseusMSA::align_bidirectional(
+    std::string_view seq,
+    int weight) {
+
+    Alignment alignment;
+    msa_aligner_impl_->align_bidirectional_into(alignment, seq, 0, 0, weight, true);
+    return alignment;
+}
+
+/**
+ * @brief Replace the heuristics of the following alignments.
+ *
+ * @param heuristics
+ */
+void TheseusMSA::set_heuristics(const Heuristics &heuristics) {
+    msa_aligner_impl_->set_heuristics(heuristics);
+}
+
+/**
+ * @brief Set the number of scores between checkpoints of align.
+ *
+ * @param interval
+ */
+void TheseusMSA::set_checkpoint_interval(int interval) {
+    msa_aligner_impl_->set_checkpoint_interval(interval);
+}
+
+/**
+ * @brief Set the number of threads computing the wavefronts of each alignment.
+ *
+ * @param num_threads
+ */
+void TheseusMSA::set_parallel_wave(int num_threads) {
+    msa_aligner_impl_->set_parallel_wave(num_threads);
 }
 
 /**
@@ -30,6 +30,8 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <limits>
+#include <span>
 #include <vector>
 // #include <type_traits>
 
@@ -56,14 +58,28 @@ public:
         int32_t end_d;     // End diagonal of the segment (inclusive)
     };
 
+    /**
+     * @brief Segment of invalid diagonals. Segments grow one diagonal down
+     * every gape expansions starting at expansion "down_time", and one
+     * diagonal up every gape expansions starting at expansion "up_time", so
+     * their bounds are computed on demand from the current expansion (see
+     * bounds) instead of being updated at every score.
+     */
     struct InvalidData {
-        Segment seg;        // Segment of invalid diagonals
-        int32_t rem_up;     // Remaining scores to grow the segment one diagonal
-                            // up
-        int32_t rem_down;   // Remaining scores to grow the segment one diagonal
-                            // down
+        Segment seg;        // Segment of invalid diagonals before growing
+        int64_t down_time;  // Expansion in which the start first grows down
+        int64_t up_time;    // Expansion in which the end first grows up
     };
 
+    /**
+     * @brief Invalid segments of a matrix of a vertex, sorted by start
+     * diagonal and pairwise disjoint and non-adjacent until expansion
+     * "merge_time", when some neighbours may touch and have to be merged.
+     */
+    struct InvalidSet {
+        std::vector<InvalidData> segments;
+        int64_t merge_time = std::numeric_limits<int64_t>::max();
+    };
 
     /**
      * @brief Vertex dat structure. It contains:
@@ -73,13 +89,18 @@ public:
     struct VertexData {
         NodeId vertex_id;
 
-        std::vector<InvalidData> _m_invalid;
+        // Last score in which the vertex stored cells or received jumps
+        int last_score = 0;
+        // Whether the vertex is scheduled to be processed (see live_vertices)
+        bool live = false;
+
+        InvalidSet _m_invalid;
 
-        std::vector<InvalidData> _i_invalid;
-        // std::vector<InvalidData> _i2_invalid;
+        InvalidSet _i_invalid;
+        // InvalidSet _i2_invalid;
 
-        std::vector<InvalidData> _d_invalid;
-        // std::vector<InvalidData> _d2_invalid;
+        InvalidSet _d_invalid;
+        // InvalidSet _d2_invalid;
 
         // Scope with the positions of M jumps in the scope previous waves
         std::vector<std::vector<pos_t>> _m_jumps_positions;
@@ -101,7 +122,8 @@ public:
      * @param nexpected_vertices    Number of expected vertices.
      */
     VerticesData(const Penalties &penalties, int nscores, int nexpected_vertices) :
-        _nscores(nscores), _penalties(penalties) {
+        _nscores(nscores), _penalties(penalties), _gape(penalties.gape()),
+        _linear_gaps(penalties.type() == Penalties::Type::Linear) {
         _active_vertices.reserve(nexpected_vertices);
         _vertex_to_idx.reserve(nexpected_vertices);
     }
@@ -113,16 +135,26 @@ public:
      * @param score  Current score
      */
     void new_score(int score) {
-        int len = _active_vertices.size();
+        merge_revived();
         int pos_curr_score = get_pos(score);
 
-        for (int l = 0; l < len; ++l) {
-            auto &vdata = _active_vertices[l];
+        size_t k = 0;
+        for (size_t l = 0; l < _live_vertices.size(); ++l) {
+            auto &vdata = _active_vertices[_live_vertices[l]];
+
+            // Retire the vertices without data in the scope: they cannot
+            // produce new cells unless a new jump reaches them
+            if (score - vdata.last_score >= _nscores) {
+                vdata.live = false;
+                continue;
+            }
+            _live_vertices[k++] = _live_vertices[l];
 
             // Clear the jumps (they work as a scope)
             vdata._m_jumps_positions[pos_curr_score].clear();
             vdata._i_jumps_positions[pos_curr_score].clear();
         }
+        _live_vertices.resize(k);
     }
 
     /**
@@ -131,8 +163,15 @@ public:
      *
      */
     void new_alignment() {
-        _active_vertices.clear();
-        _vertex_to_idx.clear();
+        // Only reset the entries of the vertices used in the last alignment
+        for (size_t l = 0; l < _nactive_vertices; ++l) {
+            _vertex_to_idx[_active_vertices[l].vertex_id] = -1;
+        }
+        // The vertex data objects are kept to reuse their buffers
+        _nactive_vertices = 0;
+        _live_vertices.clear();
+        _revived_vertices.clear();
+        _nexpansions = 0;
     }
 
     /**
@@ -186,126 +225,23 @@ public:
 
     // FUNCTIONS
     /**
-     * @brief Compact a set of ordered invalid objects to avoid redundant information.
+     * @brief Get the bounds of an invalid segment at the current expansion.
      *
+     * @param inv
+     * @return Segment
      */
-    void compact_invalid_vector(std::vector<InvalidData> &invalid_v,
-                                int default_rem_up,
-                                int default_rem_down) {
-
-        if (invalid_v.size() == 0) {
-            return;
-        }
-
-        // Order the set of segments
-        std::sort(invalid_v.begin(),
-                  invalid_v.end(),
-                  [](const InvalidData &s1, const InvalidData &s2) {
-                      return s1.seg.start_d < s2.seg.start_d;
-                  });
-
-        // Iterate through the loop
-        int k = 0;
-        for (long unsigned int l = 1; l < invalid_v.size(); ++l) {
-            // You should compact them
-            if (invalid_v[k].seg.end_d + 1 >= invalid_v[l].seg.start_d) {
-                // Update segment
-                invalid_v[k].seg.end_d = std::max(invalid_v[l].seg.end_d,
-                                                  invalid_v[k].seg.end_d);
-
-                // Update remaining down scores
-                invalid_v[k].rem_down = std::min(invalid_v[k].rem_down,
-                                                 invalid_v[l].rem_down +
-                                                     (invalid_v[l].seg.start_d -
-                                                      invalid_v[k].seg.start_d) *
-                                                         default_rem_down);
-
-                // Update remaining up scores
-                if (invalid_v[l].seg.end_d > invalid_v[k].seg.end_d) {
-                    invalid_v[k].rem_up = std::min(invalid_v[l].rem_up,
-                                                   invalid_v[k].rem_up +
-                                                       (invalid_v[l].seg.end_d -
-                                                        invalid_v[k].seg.end_d) *
-                                                           default_rem_up);
-                }
-                else {
-                    invalid_v[k].rem_up = std::min(invalid_v[k].rem_up,
-                                                   invalid_v[l].rem_up +
-                                                       (invalid_v[k].seg.end_d -
-                                                        invalid_v[l].seg.end_d) *
-                                                           default_rem_up);
-                }
-            }
-            else {
-                k += 1;
-                invalid_v[k] = invalid_v[l];
-            }
-        }
-        invalid_v.resize(k + 1);
-    }
-
-    /**
-     * @brief Expand a set of invalid objects. This means reducing the counters
-     * of remaining scores to grow and growing the segments if those counters get
-     * to 0.
-     *
-     */
-    void expand_invalid_vector(std::vector<InvalidData> &invalid_v,
-                               int default_rem_up,
-                               int default_rem_down) {
-
-        for (long unsigned int l = 0; l < invalid_v.size(); ++l) {
-            invalid_v[l].rem_down -= 1;
-            invalid_v[l].rem_up -= 1;
-
-            if (invalid_v[l].rem_up == 0) {
-                invalid_v[l].rem_up = default_rem_up;
-                invalid_v[l].seg.end_d += 1;
-            }
-            if (invalid_v[l].rem_down == 0) {
-                invalid_v[l].rem_down = default_rem_down;
-                invalid_v[l].seg.start_d -= 1;
-            }
-        }
+    Segment bounds(const InvalidData &inv) const {
+        return bounds(inv, _nexpansions);
     }
 
     /**
-     * @brief Expand all invalid objects.
+     * @brief Grow all invalid segments one step. Segment bounds are computed
+     * lazily from the number of expansions, so this does not depend on the
+     * number of active vertices or segments.
      *
      */
     void expand() {
-        for (long unsigned int l = 0; l < _active_vertices.size(); ++l) {
-            auto &vdata = _active_vertices[l];
-            expand_invalid_vector(vdata._m_invalid, _penalties.gape(), _penalties.gape());
-            expand_invalid_vector(vdata._i_invalid, _penalties.gape(), _penalties.gape());
-            expand_invalid_vector(vdata._d_invalid, _penalties.gape(), _penalties.gape());
-
-            // expand_invalid_vector(vdata._i2_invalid, TODO, TODO);
-            // expand_invalid_vector(vdata._d2_invalid, TODO, TODO);
-        }
-    }
-
-    /**
-     * @brief Compact all invalid objects.
-     *
-     */
-    void compact() {
-        for (long unsigned int l = 0; l < _active_vertices.size(); ++l) {
-            compact_invalid_vector(_active_vertices[l]._m_invalid,
-                                   _penalties.gape(),
-                                   _penalties.gape());
-            compact_invalid_vector(_active_vertices[l]._i_invalid,
-                                   _penalties.gape(),
-                                   _penalties.gape());
-            compact_invalid_vector(_active_vertices[l]._d_invalid,
-                                   _penalties.gape(),
-                                   _penalties.gape());
-
-            // compact_invalid_vector(_active_vertices[l]._i2_invalid, TODO,
-            // TODO);
-            // compact_invalid_vector(_active_vertices[l]._d2_invalid, TODO,
-            // TODO);
-        }
+        _nexpansions += 1;
     }
 
     /**
@@ -317,61 +253,53 @@ public:
      */
     void invalidate_i_jump(int idx, int diag) {
         VertexData &vdata = _active_vertices[idx];
-        InvalidData new_invalid;
 
         // New invalid in M
-        new_invalid.rem_down = _penalties.gapo() + _penalties.gape();
-        new_invalid.rem_up = _penalties.gape();
-        new_invalid.seg.start_d = diag;
-        new_invalid.seg.end_d = diag;
-        vdata._m_invalid.push_back(new_invalid);
+        insert_invalid(vdata._m_invalid, {diag, diag},
+                       _penalties.gapo() + _penalties.gape(),
+                       _penalties.gape());
 
         // New invalid in I
-        new_invalid.rem_down = 2 * _penalties.gapo() + 3 * _penalties.gape();
-        new_invalid.rem_up = _penalties.gape();
-        new_invalid.seg.start_d = diag;
-        new_invalid.seg.end_d = diag;
-        vdata._i_invalid.push_back(new_invalid);
+        insert_invalid(vdata._i_invalid, {diag, diag},
+                       2 * _penalties.gapo() + 3 * _penalties.gape(),
+                       _penalties.gape());
 
         // New invalid in D (initially empty)
-        new_invalid.rem_down = _penalties.gapo() + _penalties.gape();
-        new_invalid.rem_up = _penalties.gapo() + 2 * _penalties.gape();
-        new_invalid.seg.start_d = diag;
-        new_invalid.seg.end_d = diag - 1;
-        vdata._d_invalid.push_back(new_invalid);
+        insert_invalid(vdata._d_invalid, {diag, diag - 1},
+                       _penalties.gapo() + _penalties.gape(),
+                       _penalties.gapo() + 2 * _penalties.gape());
     }
 
     /**
      * @brief Invalidate a diagonal "diag" in vertex located at index "idx" and
      * for matrix M. This happens when a jump is performed in the M matrix.
+     * With linear gaps, only the M matrix is invalidated.
      *
      * @param idx
      * @param diag
      */
     void invalidate_m_jump(int idx, int diag) {
         VertexData &vdata = _active_vertices[idx];
-        InvalidData new_invalid;
 
         // New invalid in M
-        new_invalid.rem_down = _penalties.gapo() + _penalties.gape();
-        new_invalid.rem_up = _penalties.gapo() + _penalties.gape();
-        new_invalid.seg.start_d = diag;
-        new_invalid.seg.end_d = diag;
-        vdata._m_invalid.push_back(new_invalid);
+        insert_invalid(vdata._m_invalid, {diag, diag},
+                       _penalties.gapo() + _penalties.gape(),
+                       _penalties.gapo() + _penalties.gape());
+
+        // Linear gaps are computed in M, there are no I and D wavefronts
+        if (_linear_gaps) {
+            return;
+        }
 
         // New invalid in I (initially empty)
-        new_invalid.rem_down = 2 * (_penalties.gapo() + _penalties.gape());
-        new_invalid.rem_up = _penalties.gapo() + _penalties.gape();
-        new_invalid.seg.start_d = diag + 1;
-        new_invalid.seg.end_d = diag;
-        vdata._i_invalid.push_back(new_invalid);
+        insert_invalid(vdata._i_invalid, {diag + 1, diag},
+                       2 * (_penalties.gapo() + _penalties.gape()),
+                       _penalties.gapo() + _penalties.gape());
 
         // New invalid in D (initially empty)
-        new_invalid.rem_down = _penalties.gapo() + _penalties.gape();
-        new_invalid.rem_up = 2 * (_penalties.gapo() + _penalties.gape());
-        new_invalid.seg.start_d = diag;
-        new_invalid.seg.end_d = diag - 1;
-        vdata._d_invalid.push_back(new_invalid);
+        insert_invalid(vdata._d_invalid, {diag, diag - 1},
+                       _penalties.gapo() + _penalties.gape(),
+                       2 * (_penalties.gapo() + _penalties.gape()));
     }
 
     /**
@@ -385,36 +313,144 @@ public:
      */
     template <Cell::Matrix matrix>
     bool valid_diagonal(int vtx, int diag) {
-        std::vector<InvalidData> &invalid =
-        [this, vtx]() -> std::vector<InvalidData>& {
-            VertexData &vdata = _active_vertices[get_id(vtx)];
-            if constexpr (matrix == Cell::Matrix::M) {
-                return vdata._m_invalid;
-            }
-            else if constexpr (matrix == Cell::Matrix::I) {
-                return vdata._i_invalid;
+        InvalidSet &invalid = invalid_set<matrix>(vtx);
+        merge_if_needed(invalid);
+
+        // Sorted and disjoint segments: only the last one starting at or
+        // before diag can contain it
+        auto it = last_starting_at_or_before(invalid, diag);
+        return it == invalid.segments.end() || diag > bounds(*it).end_d;
+    }
+
+    /**
+     * @brief Check a batch of diagonals of the vertex "vtx" at once, storing
+     * in valid[l] whether diags[l] is valid. When the diagonals lie in a narrow
+     * band, the invalid segments are swept once over that band; otherwise each
+     * diagonal is binary searched.
+     *
+     * @tparam matrix
+     * @param vtx
+     * @param diags
+     * @param valid
+     */
+    template <Cell::Matrix matrix>
+    void valid_diagonals(int vtx, std::span<const Cell::idx2d_t> diags, uint8_t *valid) {
+        valid_diagonals<matrix>(vtx, diags, valid, _band);
+    }
+
+    /**
+     * @brief Same as valid_diagonals, with the given buffer for the band. The
+     * vertices of a wave can then be checked concurrently (each one by a single
+     * thread with its own buffer).
+     *
+     * @tparam matrix
+     * @param vtx
+     * @param diags
+     * @param valid
+     * @param band_validity Buffer for the validity of the band
+     */
+    template <Cell::Matrix matrix>
+    void valid_diagonals(int vtx, std::span<const Cell::idx2d_t> diags, uint8_t *valid,
+                         std::vector<uint8_t> &band_validity) {
+        if (diags.empty()) {
+            return;
+        }
+        InvalidSet &invalid = invalid_set<matrix>(vtx);
+        if (invalid.segments.empty()) {
+            std::fill(valid, valid + diags.size(), 1);
+            return;
+        }
+        const auto [min_it, max_it] = std::minmax_element(diags.begin(), diags.end());
+        const int64_t min_d = *min_it;
+        const int64_t band = *max_it - min_d + 1;
+        if (band > 4 * static_cast<int64_t>(diags.size()) + 64) {
+            for (size_t l = 0; l < diags.size(); ++l) {
+                valid[l] = valid_diagonal<matrix>(vtx, diags[l]);
             }
-            else if constexpr (matrix == Cell::Matrix::D) {
-                return vdata._d_invalid;
+            return;
+        }
+
+        // Sweep the segments overlapping the band
+        merge_if_needed(invalid);
+        band_validity.assign(band, 1);
+        auto it = last_starting_at_or_before(invalid, min_d);
+        if (it == invalid.segments.end()) {
+            it = invalid.segments.begin();
+        }
+        for (; it != invalid.segments.end(); ++it) {
+            const Segment seg = bounds(*it);
+            if (seg.start_d >= min_d + band) {
+                break;
             }
-            // else if constexpr (matrix == Cell::Matrix::I2) {
-            //     return vdata._i2_invalid;
-            // }
-            // else if constexpr (matrix == Cell::Matrix::D2) {
-            //     return vdata._d2_invalid;
-            // }
-            else {
-                static_assert([]{ return false; }(), "Unsupported matrix type");
+            const int64_t start = std::max<int64_t>(seg.start_d, min_d);
+            const int64_t end = std::min<int64_t>(seg.end_d, min_d + band - 1);
+            if (start <= end) {
+                std::fill(band_validity.begin() + (start - min_d), band_validity.begin() + (end - min_d + 1), 0);
             }
-        }();
+        }
+        for (size_t l = 0; l < diags.size(); ++l) {
+            valid[l] = band_validity[diags[l] - min_d];
+        }
+    }
+
+    /**
+     * @brief Indices of the vertices that may produce cells in the current
+     * score (those with data in the scope), in increasing order.
+     *
+     * @return const std::vector<int>&
+     */
+    const std::vector<int> &live_vertices() {
+        merge_revived();
+        return _live_vertices;
+    }
 
-        for (size_t l = 0; l < invalid.size(); ++l) {
-            if (invalid[l].seg.start_d <= diag &&
-                diag <= invalid[l].seg.end_d) {
-                return false;
+    /**
+     * @brief Record that the vertex located at index "idx" has stored cells in
+     * score "score", so it has to be processed in the following scores.
+     *
+     * @param idx
+     * @param score
+     */
+    void mark_live(int idx, int score) {
+        VertexData &vdata = _active_vertices[idx];
+        if (!vdata.live) {
+            // Jumps stored before the vertex was retired are out of the scope
+            for (int l = 0; l < _nscores; ++l) {
+                vdata._m_jumps_positions[l].clear();
+                vdata._i_jumps_positions[l].clear();
             }
+            vdata.live = true;
+            _revived_vertices.push_back(idx);
         }
-        return true;
+        vdata.last_score = score;
+    }
+
+    /**
+     * @brief Store the position "pos" of a jump to vertex "vtx" in the MJ
+     * matrix at score "score".
+     *
+     * @param vtx
+     * @param score
+     * @param pos
+     */
+    void add_m_jump(NodeId vtx, int score, pos_t pos) {
+        const int idx = _vertex_to_idx[vtx];
+        mark_live(idx, score);
+        _active_vertices[idx]._m_jumps_positions[get_pos(score)].push_back(pos);
+    }
+
+    /**
+     * @brief Store the position "pos" of a jump to vertex "vtx" in the IJ
+     * matrix at score "score".
+     *
+     * @param vtx
+     * @param score
+     * @param pos
+     */
+    void add_i_jump(NodeId vtx, int score, pos_t pos) {
+        const int idx = _vertex_to_idx[vtx];
+        mark_live(idx, score);
+        _active_vertices[idx]._i_jumps_positions[get_pos(score)].push_back(pos);
     }
 
     /**
@@ -423,7 +459,7 @@ public:
      * @return int
      */
     size_t num_active_vertices() {
-        return _active_vertices.size();
+        return _nactive_vertices;
     }
 
     /**
@@ -437,23 +473,272 @@ public:
             _vertex_to_idx.resize(2*vtx + 1, -1);
         }
         if (_vertex_to_idx[vtx] == -1) {
-            // Add the vertex to the active vertices
-            _active_vertices.push_back(VertexData());
-            _active_vertices[_active_vertices.size() - 1].vertex_id = vtx;
-            _active_vertices[_active_vertices.size() - 1]._i_jumps_positions.resize(_nscores);
-            _active_vertices[_active_vertices.size() - 1]._m_jumps_positions.resize(_nscores);
+            // Add the vertex to the active vertices, reusing the data of a
+            // previous alignment if possible
+            if (_nactive_vertices == _active_vertices.size()) {
+                _active_vertices.emplace_back();
+                _active_vertices.back()._i_jumps_positions.resize(_nscores);
+                _active_vertices.back()._m_jumps_positions.resize(_nscores);
+            }
+            VertexData &vdata = _active_vertices[_nactive_vertices];
+            vdata.vertex_id = vtx;
+            vdata.last_score = 0;
+            vdata.live = false;
+            clear_invalid_set(vdata._m_invalid);
+            clear_invalid_set(vdata._i_invalid);
+            clear_invalid_set(vdata._d_invalid);
+            // The jumps are cleared when the vertex becomes live
 
             // Determine the vertex id
-            _vertex_to_idx[vtx] = _active_vertices.size() - 1;
+            _vertex_to_idx[vtx] = _nactive_vertices++;
         }
     }
 
 private:
-    const Penalties &_penalties;
+    /**
+     * @brief Remove all the segments of an invalid set, keeping its buffer.
+     *
+     */
+    static void clear_invalid_set(InvalidSet &invalid) {
+        invalid.segments.clear();
+        invalid.merge_time = std::numeric_limits<int64_t>::max();
+    }
+
+    /**
+     * @brief Add the vertices revived since the last call to the live ones,
+     * keeping them sorted so that vertices are always processed in activation
+     * order.
+     *
+     */
+    void merge_revived() {
+        if (_revived_vertices.empty()) {
+            return;
+        }
+        std::sort(_revived_vertices.begin(), _revived_vertices.end());
+        // Merge from the back (std::inplace_merge may allocate a buffer)
+        size_t nlive = _live_vertices.size();
+        size_t nrevived = _revived_vertices.size();
+        _live_vertices.resize(nlive + nrevived);
+        while (nrevived > 0) {
+            if (nlive > 0 && _live_vertices[nlive - 1] > _revived_vertices[nrevived - 1]) {
+                _live_vertices[nlive + nrevived - 1] = _live_vertices[nlive - 1];
+                nlive -= 1;
+            }
+            else {
+                _live_vertices[nlive + nrevived - 1] = _revived_vertices[nrevived - 1];
+                nrevived -= 1;
+            }
+        }
+        _revived_vertices.clear();
+    }
+
+    /**
+     * @brief Get the bounds of an invalid segment after "nexpansions"
+     * expansions.
+     *
+     * @param inv
+     * @param nexpansions
+     * @return Segment
+     */
+    Segment bounds(const InvalidData &inv, int64_t nexpansions) const {
+        Segment seg = inv.seg;
+        if (nexpansions >= inv.down_time) {
+            seg.start_d -= 1 + (nexpansions - inv.down_time) / _gape;
+        }
+        if (nexpansions >= inv.up_time) {
+            seg.end_d += 1 + (nexpansions - inv.up_time) / _gape;
+        }
+        return seg;
+    }
+
+    /**
+     * @brief Check if two consecutive segments touch (overlap or are adjacent)
+     * after "nexpansions" expansions.
+     *
+     */
+    bool touch(const InvalidData &lower, const InvalidData &upper, int64_t nexpansions) const {
+        return bounds(lower, nexpansions).end_d + 1 >= bounds(upper, nexpansions).start_d;
+    }
+
+    /**
+     * @brief First expansion (not before the current one) in which two
+     * consecutive segments touch.
+     *
+     */
+    int64_t touch_time(const InvalidData &lower, const InvalidData &upper) const {
+        int64_t lo = _nexpansions;
+        if (touch(lower, upper, lo)) {
+            return lo;
+        }
+        // The gap closes at least one diagonal every gape expansions once the
+        // lower segment grows up
+        int64_t step = _gape;
+        int64_t hi = std::max(lo, lower.up_time) + step;
+        while (!touch(lower, upper, hi)) {
+            lo = hi;
+            step *= 2;
+            hi += step;
+        }
+        while (hi - lo > 1) {
+            const int64_t mid = lo + (hi - lo) / 2;
+            if (touch(lower, upper, mid)) {
+                hi = mid;
+            }
+            else {
+                lo = mid;
+            }
+        }
+        return hi;
+    }
+
+    /**
+     * @brief Merge two touching segments into "into". Starts (and ends) of
+     * both segments move one diagonal every gape expansions, so the lowest
+     * start (highest end) of the two is again such a segment: the one
+     * reaching a common reference diagonal first.
+     *
+     */
+    void merge_into(InvalidData &into, const InvalidData &other) const {
+        const int32_t start = std::min(into.seg.start_d, other.seg.start_d);
+        const int32_t end = std::max(into.seg.end_d, other.seg.end_d);
+        into.down_time = std::min(into.down_time + int64_t{into.seg.start_d - start} * _gape,
+                                  other.down_time + int64_t{other.seg.start_d - start} * _gape);
+        into.up_time = std::min(into.up_time + int64_t{end - into.seg.end_d} * _gape,
+                                other.up_time + int64_t{end - other.seg.end_d} * _gape);
+        into.seg = {start, end};
+    }
+
+    /**
+     * @brief Recompute the next expansion in which two consecutive segments
+     * touch.
+     *
+     */
+    void update_merge_time(InvalidSet &invalid) const {
+        invalid.merge_time = std::numeric_limits<int64_t>::max();
+        for (size_t l = 1; l < invalid.segments.size(); ++l) {
+            invalid.merge_time = std::min(invalid.merge_time,
+                                          touch_time(invalid.segments[l - 1], invalid.segments[l]));
+        }
+    }
+
+    /**
+     * @brief Merge the segments that have grown into their neighbours, if any.
+     *
+     */
+    void merge_if_needed(InvalidSet &invalid) const {
+        if (_nexpansions < invalid.merge_time || invalid.segments.empty()) {
+            return;
+        }
+        auto &segments = invalid.segments;
+        size_t k = 0;
+        for (size_t l = 1; l < segments.size(); ++l) {
+            if (touch(segments[k], segments[l], _nexpansions)) {
+                merge_into(segments[k], segments[l]);
+            }
+            else {
+                segments[++k] = segments[l];
+            }
+        }
+        segments.resize(k + 1);
+        update_merge_time(invalid);
+    }
+
+    /**
+     * @brief Insert a new invalid segment, merging it with the neighbours it
+     * touches.
+     *
+     * @param invalid
+     * @param seg          Initial segment
+     * @param rem_down     Expansions until the start grows down
+     * @param rem_up       Expansions until the end grows up
+     */
+    void insert_invalid(InvalidSet &invalid, Segment seg, int rem_down, int rem_up) {
+        merge_if_needed(invalid);
+        InvalidData new_invalid{seg, _nexpansions + rem_down, _nexpansions + rem_up};
+
+        auto &segments = invalid.segments;
+        auto it = std::upper_bound(segments.begin(), segments.end(), seg.start_d,
+                                   [this](int d, const InvalidData &inv) {
+                                       return d < bounds(inv).start_d;
+                                   });
+        size_t pos = it - segments.begin();
+        // Merge with the touching neighbours (below and above)
+        while (pos > 0 && touch(segments[pos - 1], new_invalid, _nexpansions)) {
+            merge_into(new_invalid, segments[pos - 1]);
+            segments.erase(segments.begin() + (pos - 1));
+            pos -= 1;
+        }
+        while (pos < segments.size() && touch(new_invalid, segments[pos], _nexpansions)) {
+            merge_into(new_invalid, segments[pos]);
+            segments.erase(segments.begin() + pos);
+        }
+        segments.insert(segments.begin() + pos, new_invalid);
+
+        if (pos > 0) {
+            invalid.merge_time = std::min(invalid.merge_time, touch_time(segments[pos - 1], segments[pos]));
+        }
+        if (pos + 1 < segments.size()) {
+            invalid.merge_time = std::min(invalid.merge_time, touch_time(segments[pos], segments[pos + 1]));
+        }
+    }
 
-    std::vector<VertexData> _active_vertices;
+    /**
+     * @brief Find the last segment starting at or before "diag", or end() if
+     * there is none. The segments must be sorted and disjoint.
+     *
+     */
+    std::vector<InvalidData>::iterator last_starting_at_or_before(InvalidSet &invalid, int64_t diag) const {
+        auto it = std::upper_bound(invalid.segments.begin(), invalid.segments.end(), diag,
+                                   [this](int64_t d, const InvalidData &inv) {
+                                       return d < bounds(inv).start_d;
+                                   });
+        return (it == invalid.segments.begin()) ? invalid.segments.end() : std::prev(it);
+    }
+
+    /**
+     * @brief Get the invalid segments of a matrix of the vertex "vtx".
+     *
+     * @tparam matrix
+     * @param vtx
+     * @return InvalidSet&
+     */
+    template <Cell::Matrix matrix>
+    InvalidSet &invalid_set(int vtx) {
+        VertexData &vdata = _active_vertices[get_id(vtx)];
+        if constexpr (matrix == Cell::Matrix::M) {
+            return vdata._m_invalid;
+        }
+        else if constexpr (matrix == Cell::Matrix::I) {
+            return vdata._i_invalid;
+        }
+        else if constexpr (matrix == Cell::Matrix::D) {
+            return vdata._d_invalid;
+        }
+        // else if constexpr (matrix == Cell::Matrix::I2) {
+        //     return vdata._i2_invalid;
+        // }
+        // else if constexpr (matrix == Cell::Matrix::D2) {
+        //     return vdata._d2_invalid;
+        // }
+        else {
+            static_assert([]{ return false; }(), "Unsupported matrix type");
+        }
+    }
+
+    Penalties _penalties;
+    int64_t _gape;              // Scores to grow a segment one diagonal
+    bool _linear_gaps;          // Only the M matrix is computed
+    int64_t _nexpansions = 0;   // Number of expansions in the current alignment
+
+    std::vector<VertexData> _active_vertices;    // The first _nactive_vertices are in use
+    size_t _nactive_vertices = 0;
 
     std::vector<int> _vertex_to_idx;
+
+    std::vector<int> _live_vertices;      // Vertices processed in each score
+    std::vector<int> _revived_vertices;   // Vertices to add to the live ones
+
+    std::vector<uint8_t> _band;   // Validity of a band of diagonals (valid_diagonals)
 };
 
 }   // namespace theseus
\ No newline at end of file
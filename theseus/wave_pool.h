@@ -0,0 +1,147 @@
+/*
+ *                             The MIT License
+ *
+ * Copyright (c) 2024 by Albert Jimenez-Blanco
+ *
+ * This file is part of #################### Theseus Library ####################.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Pool of threads that run the tasks of the parallel wave (see
+ * TheseusAlignerImpl::set_parallel_wave) and the sequences of a batch (see
+ * TheseusAligner::align_batch). The threads are kept for the whole life of
+ * the aligner and wait between waves, so starting a wave only costs a
+ * wake-up. The calling thread also runs tasks, as lane 0.
+ *
+ */
+
+namespace theseus {
+
+class WavePool {
+public:
+    using Task = std::function<void(int lane, size_t task)>;
+
+    /**
+     * @brief Construct a new pool.
+     *
+     * @param nlanes Number of threads running the tasks (including the caller)
+     */
+    WavePool(int nlanes) {
+        for (int lane = 1; lane < nlanes; ++lane) {
+            _threads.emplace_back([this, lane]() { wait_for_tasks(lane); });
+        }
+    }
+
+    ~WavePool() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _start.notify_all();
+        for (auto &thread : _threads) {
+            thread.join();
+        }
+    }
+
+    /**
+     * @brief Get the number of threads running the tasks (including the caller).
+     *
+     * @return int
+     */
+    int size() const {
+        return _threads.size() + 1;
+    }
+
+    /**
+     * @brief Run task(lane, t) for every t in [0, ntasks) and wait for all of
+     * them. Each thread takes the next task as soon as it finishes one, and
+     * "lane" identifies the thread running it.
+     *
+     * @param ntasks
+     * @param task
+     */
+    void run(size_t ntasks, const Task &task) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _task = &task;
+            _ntasks = ntasks;
+            _next_task = 0;
+            _nbusy = _threads.size();
+            _generation += 1;
+        }
+        _start.notify_all();
+        run_tasks(0);
+        std::unique_lock<std::mutex> lock(_mutex);
+        _done.wait(lock, [this]() { return _nbusy == 0; });
+        _task = nullptr;
+    }
+
+private:
+    void run_tasks(int lane) {
+        for (size_t t = _next_task++; t < _ntasks; t = _next_task++) {
+            (*_task)(lane, t);
+        }
+    }
+
+    void wait_for_tasks(int lane) {
+        uint64_t generation = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _start.wait(lock, [&]() { return _stop || _generation != generation; });
+                if (_stop) {
+                    return;
+                }
+                generation = _generation;
+            }
+            run_tasks(lane);
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (--_nbusy == 0) {
+                _done.notify_one();
+            }
+        }
+    }
+
+    std::vector<std::thread> _threads;
+    std::mutex _mutex;
+    std::condition_variable _start;   // A new wave is ready
+    std::condition_variable _done;    // All the threads finished the wave
+    const Task *_task = nullptr;
+    size_t _ntasks = 0;
+    std::atomic<size_t> _next_task{0};
+    size_t _nbusy = 0;                // Threads (other than the caller) still running tasks
+    uint64_t _generation = 0;         // Number of waves started
+    bool _stop = false;
+};
+
+}   // namespace theseus
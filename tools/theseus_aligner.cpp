@@ -63,6 +63,22 @@ struct CMDArgs {
     // Heuristics
     bool density_drop = false;
     bool lag_pruning  = false;
+    int  adaptive_threshold = -1;
+    int  adaptive_period    = 10;
+    // Budgets (negative values set no limit)
+    int     max_score          = -1;
+    double  max_score_per_base = -1;
+    int64_t max_cells          = -1;
+    // Extension (negative values disable it)
+    int xdrop = -1;
+    // Ends-free alignment
+    bool free_query_suffix = false;
+    bool end_at_sink       = false;
+    // Memory
+    bool packed = false;
+    // Parallelism
+    int threads = 1;
+    int wave_threads = 1;
     // I/O
     std::string graph_file;
     std::string sequences_and_positions_file;
@@ -290,7 +306,30 @@ void help() {
 
                  " Heuristics:\n"
                  "  -d  --density_heuristic     Activate the drop heuristic based on advancement density.            \n"
-                 "  -l  --lag_pruning           Activate the pruning of diagonals lagging behind int the alignment.  \n";
+                 "  -l  --lag_pruning           Activate the pruning of diagonals lagging behind int the alignment.  \n"
+                 "  -a  --adaptive_threshold <int>  Prune the cells this many bases further from the query end    \n"
+                 "                              than the closest one (adaptive reduction).                           \n"
+                 "  -P  --adaptive_period <int> Scores between updates of the adaptive reduction.       [default=10]\n\n"
+
+                 " Budgets:\n"
+                 "  -S  --max_score <int>       Stop the alignments whose score exceeds this value.                  \n"
+                 "  -r  --max_score_per_base <float>  Stop the alignments whose score exceeds this value per base. \n"
+                 "  -c  --max_cells <int>       Stop the alignments that keep more cells than this value.            \n\n"
+
+                 " Extension:\n"
+                 "  -X  --xdrop <int>           Extend from the start position and stop when the alignment falls     \n"
+                 "                              this score behind the best extension (0.5 per aligned base).         \n\n"
+
+                 " Ends-free alignment:\n"
+                 "  -q  --free_query_suffix     Leave the rest of the query unaligned at the end of a sink node.     \n"
+                 "  -t  --end_at_sink           End the alignments at the end of a sink node.                        \n\n"
+
+                 " Memory:\n"
+                 "  -p  --packed                Store the graph sequences with 2 bits per base.                      \n\n"
+
+                 " Parallelism:\n"
+                 "  -j  --threads <int>         Number of threads aligning sequences (0 uses all).       [default=1]\n"
+                 "  -W  --wave_threads <int>    Number of threads computing each alignment.              [default=1]\n";
 }
 
 CMDArgs parse_args(int argc, char *const *argv) {
@@ -303,13 +342,24 @@ CMDArgs parse_args(int argc, char *const *argv) {
                                           {"output_file", required_argument, 0, 'f'},
                                           {"lag_pruning", no_argument, 0, 'l'},
                                           {"density_heuristic", no_argument, 0, 'd'},
+                                          {"packed", no_argument, 0, 'p'},
+                                          {"max_score", required_argument, 0, 'S'},
+                                          {"max_score_per_base", required_argument, 0, 'r'},
+                                          {"max_cells", required_argument, 0, 'c'},
+                                          {"adaptive_threshold", required_argument, 0, 'a'},
+                                          {"adaptive_period", required_argument, 0, 'P'},
+                                          {"xdrop", required_argument, 0, 'X'},
+                                          {"free_query_suffix", no_argument, 0, 'q'},
+                                          {"end_at_sink", no_argument, 0, 't'},
+                                          {"threads", required_argument, 0, 'j'},
+                                          {"wave_threads", required_argument, 0, 'W'},
                                           {0, 0, 0, 0}};
 
     CMDArgs args;
 
     int opt;
     int option_index = 0;
-    while ((opt = getopt_long(argc, argv, "m:x:o:e:g:s:f:ld", long_options, &option_index)) != -1) {
+    while ((opt = getopt_long(argc, argv, "m:x:o:e:g:s:f:ldpa:P:S:r:c:X:qtj:W:", long_options, &option_index)) != -1) {
         switch (opt) {
             case 'm':
                 args.match = std::stoi(optarg);
@@ -338,6 +388,39 @@ CMDArgs parse_args(int argc, char *const *argv) {
             case 'd':
                 args.density_drop = true;
                 break;
+            case 'p':
+                args.packed = true;
+                break;
+            case 'S':
+                args.max_score = std::stoi(optarg);
+                break;
+            case 'r':
+                args.max_score_per_base = std::stod(optarg);
+                break;
+            case 'c':
+                args.max_cells = std::stoll(optarg);
+                break;
+            case 'a':
+                args.adaptive_threshold = std::stoi(optarg);
+                break;
+            case 'P':
+                args.adaptive_period = std::stoi(optarg);
+                break;
+            case 'X':
+                args.xdrop = std::stoi(optarg);
+                break;
+            case 'q':
+                args.free_query_suffix = true;
+                break;
+            case 't':
+                args.end_at_sink = true;
+                break;
+            case 'j':
+                args.threads = std::stoi(optarg);
+                break;
+            case 'W':
+                args.wave_threads = std::stoi(optarg);
+                break;
             default:
                 std::cerr << "Invalid option" << std::endl;
                 exit(1);
@@ -362,6 +445,11 @@ int main(int argc, char *const *argv) {
     theseus::Penalties penalties(args.match, args.mismatch, args.gapo, args.gape);
     // Parse heuristics
     theseus::Heuristics heuristics;
+    heuristics.set_max_score(args.max_score);
+    heuristics.set_max_score_per_base(args.max_score_per_base);
+    heuristics.set_max_cells(args.max_cells);
+    heuristics.set_adaptive_reduction(args.adaptive_threshold, args.adaptive_period);
+    heuristics.set_xdrop(args.xdrop);
     // Manage input/output files
     std::ifstream graph_file(args.graph_file);
     std::ifstream sp_file(args.sequences_and_positions_file);
@@ -371,8 +459,12 @@ int main(int argc, char *const *argv) {
     std::unordered_map<std::string, NodeId> name_to_id;
     std::unordered_map<NodeId, std::string> node_names;
     graph_from_gfa_stream(graph_file, graph, name_to_id, node_names);
+    if (args.packed) {
+        graph.pack_sequences();
+    }
     // Prepare the aligner
     theseus::TheseusAligner aligner(penalties, heuristics, std::move(graph));
+    aligner.set_parallel_wave(args.wave_threads);
     // Read queries data
     std::vector<std::string> sequences;
     std::vector<NodeId> start_nodes;
@@ -381,13 +473,19 @@ int main(int argc, char *const *argv) {
     // Align the sequences
     std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
     int num_sequences = sequences.size();
-    theseus::Alignment alignment;
+    theseus::EndsFree ends_free;
+    ends_free.query_suffix = args.free_query_suffix;
+    ends_free.graph_suffix = !args.end_at_sink;
+    std::vector<std::string_view> sequence_views(sequences.begin(), sequences.end());
+    std::vector<theseus::Alignment> alignments = aligner.align_batch(sequence_views, start_nodes, start_offsets,
+                                                                     args.threads, args.density_drop,
+                                                                     args.lag_pruning, ends_free);
     for (int i = 0; i < num_sequences; ++i) {
-        // Perform alignment
+        theseus::Alignment &alignment = alignments[i];
         std::cout << "Seq " << i << std::endl;
-        alignment = aligner.align(sequences[i], start_nodes[i], start_offsets[i], args.density_drop, args.lag_pruning);
         std::cout << "Score = " << alignment.compute_affine_gap_score(penalties) << std::endl << std::endl;
-        if (alignment.theseus_status != THESEUS_STATUS_ALG_COMPLETED) {
+        if (alignment.theseus_status != THESEUS_STATUS_ALG_COMPLETED &&
+            alignment.theseus_status != THESEUS_STATUS_ALG_PARTIAL) {
             std::cerr << "Alignment " << i << " with status " << alignment.theseus_status << " did not complete successfully" << std::endl;
         }
         aligner.print_alignment_as_gaf(alignment, output_file, "seq_" + std::to_string(i), node_names);